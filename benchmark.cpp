@@ -0,0 +1,284 @@
+#include <algorithm>
+#include <chrono>
+
+#include <iostream>
+#include <iomanip>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "qqwing.hpp"
+#include "solver.hpp"
+
+// Benchmark settings, from the command line
+struct BenchmarkOptions
+{
+	// Seed for generating the corpus, so every run uses the same puzzles
+	uint32_t seed;
+
+	// Puzzles per difficulty
+	uint32_t puzzles;
+
+	// Untimed passes over each bucket before measuring
+	uint32_t warmup;
+
+	// Timed passes over each bucket
+	uint32_t repetitions;
+};
+
+// A puzzle in the benchmark corpus, 1-9 for givens and 0 for blanks
+struct Puzzle
+{
+	int board[NUM_CELLS];
+};
+
+// Corpus puzzles that QQWING gave one difficulty
+struct Bucket
+{
+	qqwing::SudokuBoard::Difficulty difficulty;
+	const char* name;
+	std::vector<Puzzle> puzzles;
+};
+
+// Latency and throughput of one solver over one bucket
+struct BenchmarkResult
+{
+	uint32_t solved;
+	uint64_t medianNs;
+	uint64_t p99Ns;
+	double puzzlesPerSecond;
+};
+
+// A solver under test, returning whether the puzzle was completely solved
+typedef bool (*SolveFunction)(const int* board);
+
+struct Solver
+{
+	const char* name;
+	SolveFunction solve;
+};
+
+// Give up filling buckets after this many generated puzzles per puzzle wanted
+static const uint32_t MAX_ATTEMPTS_PER_PUZZLE = 200;
+
+// Generate puzzles with QQWING until every bucket is full
+void generateCorpus(const BenchmarkOptions& options, std::vector<Bucket>& buckets);
+
+// Time one solver over every puzzle in a bucket
+BenchmarkResult runBenchmark(const Solver& solver, const Bucket& bucket, const BenchmarkOptions& options);
+
+bool solveWithSolver(const int* board);
+bool solveWithQqwing(const int* board);
+bool solveWithQqwingBatch(const int* board);
+
+qqwing::SudokuBoard qqwingBoard;
+
+const Solver SOLVERS[] =
+{
+	{ "solver", solveWithSolver },
+	{ "qqwing", solveWithQqwing },
+	{ "qqbatch", solveWithQqwingBatch }
+};
+
+static const uint16_t NUM_SOLVERS = sizeof(SOLVERS) / sizeof(SOLVERS[0]);
+
+int main(int argc, char* argv[])
+{
+	BenchmarkOptions options;
+	options.seed = 1;
+	options.puzzles = 100;
+	options.warmup = 1;
+	options.repetitions = 5;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-seed") == 0 && i + 1 < argc)
+		{
+			options.seed = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-puzzles") == 0 && i + 1 < argc)
+		{
+			options.puzzles = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-warmup") == 0 && i + 1 < argc)
+		{
+			options.warmup = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-reps") == 0 && i + 1 < argc)
+		{
+			options.repetitions = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "-adaptive") == 0)
+		{
+			adaptiveOrdering = true;
+		}
+		else
+		{
+			std::cout << "Usage: " << argv[0] << " [-seed S] [-puzzles N] [-warmup W] [-reps R] [-adaptive]" << std::endl;
+			return 1;
+		}
+	}
+
+	if (options.repetitions == 0)
+	{
+		options.repetitions = 1;
+	}
+
+	// Only the timings are wanted, never boards or solve histories
+	setOutputEnabled(false);
+
+	std::vector<Bucket> buckets;
+	generateCorpus(options, buckets);
+
+	std::cout << std::left << std::setw(14) << "Difficulty" << std::setw(8) << "Solver" << std::right
+		<< std::setw(9) << "Puzzles"
+		<< std::setw(9) << "Solved"
+		<< std::setw(14) << "Median (us)"
+		<< std::setw(14) << "p99 (us)"
+		<< std::setw(14) << "Puzzles/s" << std::endl;
+
+	for (uint16_t b = 0; b < buckets.size(); ++b)
+	{
+		if (buckets[b].puzzles.empty())
+		{
+			continue;
+		}
+
+		for (uint16_t s = 0; s < NUM_SOLVERS; ++s)
+		{
+			BenchmarkResult result = runBenchmark(SOLVERS[s], buckets[b], options);
+
+			std::cout << std::left << std::setw(14) << buckets[b].name << std::setw(8) << SOLVERS[s].name << std::right
+				<< std::setw(9) << buckets[b].puzzles.size()
+				<< std::setw(9) << result.solved
+				<< std::setw(14) << std::fixed << std::setprecision(2) << result.medianNs / 1000.0
+				<< std::setw(14) << result.p99Ns / 1000.0
+				<< std::setw(14) << std::setprecision(0) << result.puzzlesPerSecond
+				<< std::defaultfloat << std::endl;
+		}
+	}
+
+	return 0;
+}
+
+// Generate puzzles with QQWING until every bucket is full
+void generateCorpus(const BenchmarkOptions& options, std::vector<Bucket>& buckets)
+{
+	const qqwing::SudokuBoard::Difficulty difficulties[] =
+	{
+		qqwing::SudokuBoard::SIMPLE,
+		qqwing::SudokuBoard::EASY,
+		qqwing::SudokuBoard::INTERMEDIATE,
+		qqwing::SudokuBoard::EXPERT
+	};
+	const char* names[] = { "Simple", "Easy", "Intermediate", "Expert" };
+
+	for (uint16_t d = 0; d < 4; ++d)
+	{
+		Bucket bucket;
+		bucket.difficulty = difficulties[d];
+		bucket.name = names[d];
+		buckets.push_back(bucket);
+	}
+
+	srand(options.seed);
+	qqwing::SudokuBoard ss;
+	ss.setRecordHistory(true);
+
+	uint32_t remaining = options.puzzles * (uint32_t)buckets.size();
+	uint32_t maxAttempts = remaining * MAX_ATTEMPTS_PER_PUZZLE;
+	for (uint32_t attempt = 0; attempt < maxAttempts && remaining > 0; ++attempt)
+	{
+		ss.generatePuzzle();
+
+		Puzzle puzzle;
+		memcpy(puzzle.board, ss.getPuzzle(), sizeof(puzzle.board));
+
+		// Grade the puzzle
+		ss.solve();
+		qqwing::SudokuBoard::Difficulty difficulty = ss.getDifficulty();
+
+		for (uint16_t b = 0; b < buckets.size(); ++b)
+		{
+			if (buckets[b].difficulty == difficulty && buckets[b].puzzles.size() < options.puzzles)
+			{
+				buckets[b].puzzles.push_back(puzzle);
+				--remaining;
+			}
+		}
+	}
+}
+
+// Time one solver over every puzzle in a bucket
+BenchmarkResult runBenchmark(const Solver& solver, const Bucket& bucket, const BenchmarkOptions& options)
+{
+	BenchmarkResult result;
+	result.solved = 0;
+
+	// Warm up caches and branch predictors
+	for (uint32_t w = 0; w < options.warmup; ++w)
+	{
+		for (size_t p = 0; p < bucket.puzzles.size(); ++p)
+		{
+			solver.solve(bucket.puzzles[p].board);
+		}
+	}
+
+	std::vector<uint64_t> latencies;
+	latencies.reserve(bucket.puzzles.size() * options.repetitions);
+
+	uint64_t totalNs = 0;
+	for (uint32_t r = 0; r < options.repetitions; ++r)
+	{
+		for (size_t p = 0; p < bucket.puzzles.size(); ++p)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+
+			bool solved = solver.solve(bucket.puzzles[p].board);
+
+			auto stop = std::chrono::high_resolution_clock::now();
+
+			uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+			latencies.push_back(ns);
+			totalNs += ns;
+
+			if (r == 0 && solved)
+			{
+				++result.solved;
+			}
+		}
+	}
+
+	std::sort(latencies.begin(), latencies.end());
+	result.medianNs = latencies[latencies.size() / 2];
+	result.p99Ns = latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)];
+	result.puzzlesPerSecond = (totalNs == 0) ? 0.0 : latencies.size() * 1e9 / totalNs;
+
+	return result;
+}
+
+bool solveWithSolver(const int* board)
+{
+	loadGrid(board);
+	solveGrid();
+
+	return isGridSolved();
+}
+
+bool solveWithQqwing(const int* board)
+{
+	qqwingBoard.setBatchSolve(false);
+	qqwingBoard.setPuzzle((int*)board);
+
+	return qqwingBoard.solve();
+}
+
+// QQWING placing every single it finds in a sweep at once, as the C API does
+bool solveWithQqwingBatch(const int* board)
+{
+	qqwingBoard.setBatchSolve(true);
+	qqwingBoard.setPuzzle((int*)board);
+
+	return qqwingBoard.solve();
+}
@@ -0,0 +1,142 @@
+#include "cache.hpp"
+
+#include <string.h>
+
+bool CacheKey::operator==(const CacheKey& other) const
+{
+	return hash == other.hash && memcmp(packed, other.packed, CACHE_KEY_SIZE) == 0;
+}
+
+// Pack 81 digits (0 for blanks) into a key
+void makeCacheKey(const uint8_t* digits, CacheKey& key)
+{
+	for (uint16_t i = 0; i + 1 < CACHE_CELLS; i += 2)
+	{
+		key.packed[i / 2] = (uint8_t)(digits[i] | (digits[i + 1] << 4));
+	}
+	key.packed[CACHE_CELLS / 2] = digits[CACHE_CELLS - 1];
+
+	// FNV-1a over the packed cells, then a final mix so the low bits used to pick
+	// a shard depend on every cell
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	for (uint16_t i = 0; i < CACHE_KEY_SIZE; ++i)
+	{
+		hash = (hash ^ key.packed[i]) * 0x100000001B3ULL;
+	}
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDULL;
+	hash ^= hash >> 33;
+	key.hash = hash;
+}
+
+SolutionCache::SolutionCache(size_t capacity, uint16_t shardCount) :
+	shards(shardCount == 0 ? 1 : shardCount)
+{
+	size_t perShard = (capacity + shards.size() - 1) / shards.size();
+	if (perShard == 0)
+	{
+		perShard = 1;
+	}
+
+	for (size_t s = 0; s < shards.size(); ++s)
+	{
+		Shard& shard = shards[s];
+		shard.slots.resize(perShard);
+		shard.index.reserve(perShard);
+		shard.hand = 0;
+		shard.hits = 0;
+		shard.misses = 0;
+		shard.insertions = 0;
+		shard.evictions = 0;
+	}
+}
+
+SolutionCache::Shard& SolutionCache::getShard(const CacheKey& key)
+{
+	// The top bits pick the shard, leaving the low bits to the shard's hash table
+	return shards[(key.hash >> 48) % shards.size()];
+}
+
+bool SolutionCache::find(const CacheKey& key, CachedSolution& value)
+{
+	Shard& shard = getShard(key);
+	std::lock_guard<std::mutex> guard(shard.lock);
+
+	auto found = shard.index.find(key);
+	if (found == shard.index.end())
+	{
+		++shard.misses;
+		return false;
+	}
+
+	Slot& slot = shard.slots[found->second];
+	slot.referenced = true;
+	value = slot.value;
+	++shard.hits;
+	return true;
+}
+
+// Add or replace an entry, evicting another if the shard is full
+void SolutionCache::insert(const CacheKey& key, const CachedSolution& value)
+{
+	Shard& shard = getShard(key);
+	std::lock_guard<std::mutex> guard(shard.lock);
+
+	auto found = shard.index.find(key);
+	if (found != shard.index.end())
+	{
+		Slot& slot = shard.slots[found->second];
+		slot.value = value;
+		slot.referenced = true;
+		return;
+	}
+
+	// Sweep for a free slot, or one not used since the hand last went past
+	for (;;)
+	{
+		Slot& slot = shard.slots[shard.hand];
+		if (!slot.used || !slot.referenced)
+		{
+			break;
+		}
+
+		slot.referenced = false;
+		shard.hand = (shard.hand + 1) % shard.slots.size();
+	}
+
+	uint32_t position = shard.hand;
+	Slot& slot = shard.slots[position];
+	if (slot.used)
+	{
+		shard.index.erase(slot.key);
+		++shard.evictions;
+	}
+
+	slot.key = key;
+	slot.value = value;
+	slot.used = true;
+	slot.referenced = false;
+	shard.index[key] = position;
+	shard.hand = (shard.hand + 1) % shard.slots.size();
+	++shard.insertions;
+}
+
+CacheStats SolutionCache::getStats()
+{
+	CacheStats stats;
+	memset(&stats, 0, sizeof(stats));
+
+	for (size_t s = 0; s < shards.size(); ++s)
+	{
+		Shard& shard = shards[s];
+		std::lock_guard<std::mutex> guard(shard.lock);
+		stats.hits += shard.hits;
+		stats.misses += shard.misses;
+		stats.insertions += shard.insertions;
+		stats.evictions += shard.evictions;
+		stats.entries += shard.index.size();
+		stats.capacity += shard.slots.size();
+	}
+
+	return stats;
+}
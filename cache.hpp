@@ -0,0 +1,102 @@
+#ifndef CACHE_HPP
+#define CACHE_HPP
+
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+static const uint16_t CACHE_KEY_SIZE = 41;
+static const uint16_t CACHE_CELLS = 81;
+
+// The givens of a puzzle packed two cells to a byte, with a hash of them
+struct CacheKey
+{
+	uint8_t packed[CACHE_KEY_SIZE];
+	uint64_t hash;
+
+	bool operator==(const CacheKey& other) const;
+};
+
+// Pack 81 digits (0 for blanks) into a key
+void makeCacheKey(const uint8_t* digits, CacheKey& key);
+
+// What is remembered about a puzzle
+struct CachedSolution
+{
+	// A sudoku_status from sudoku.h
+	uint8_t status;
+
+	// QQWING difficulty, or 0 (UNKNOWN) if the puzzle has not been graded
+	uint8_t difficulty;
+
+	// 1-9 for every cell when status is SUDOKU_OK
+	uint8_t solution[CACHE_CELLS];
+};
+
+struct CacheStats
+{
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t insertions;
+	uint64_t evictions;
+	uint64_t entries;
+	uint64_t capacity;
+};
+
+// A bounded cache of solutions, safe to use from many threads at once.
+// Entries are spread over shards by hash, each shard with its own lock, and
+// each shard evicts with the CLOCK algorithm: a hand sweeps the slots, giving
+// recently used entries a second chance and evicting the first that has not
+// been used since the hand last passed.
+class SolutionCache
+{
+public:
+	SolutionCache(size_t capacity, uint16_t shardCount = 16);
+
+	SolutionCache(const SolutionCache&) = delete;
+	SolutionCache& operator=(const SolutionCache&) = delete;
+
+	bool find(const CacheKey& key, CachedSolution& value);
+
+	// Add or replace an entry, evicting another if the shard is full
+	void insert(const CacheKey& key, const CachedSolution& value);
+
+	CacheStats getStats();
+
+private:
+	struct KeyHash
+	{
+		size_t operator()(const CacheKey& key) const
+		{
+			return (size_t)key.hash;
+		}
+	};
+
+	struct Slot
+	{
+		CacheKey key;
+		CachedSolution value;
+		bool used;
+		bool referenced;
+	};
+
+	struct Shard
+	{
+		std::mutex lock;
+		std::vector<Slot> slots;
+		std::unordered_map<CacheKey, uint32_t, KeyHash> index;
+		uint32_t hand;
+		uint64_t hits;
+		uint64_t misses;
+		uint64_t insertions;
+		uint64_t evictions;
+	};
+
+	Shard& getShard(const CacheKey& key);
+
+	std::vector<Shard> shards;
+};
+
+#endif
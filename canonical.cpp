@@ -0,0 +1,372 @@
+#include "canonical.hpp"
+
+#include <string.h>
+#include <vector>
+
+static const uint16_t UNIT_SIZE = 9;
+static const uint16_t CELLS = UNIT_SIZE * UNIT_SIZE;
+
+// Orderings of the three rows of a band, or three bands of a grid
+static const uint8_t ORDERS_OF_THREE[6][3] =
+{
+	{ 0, 1, 2 },
+	{ 0, 2, 1 },
+	{ 1, 0, 2 },
+	{ 1, 2, 0 },
+	{ 2, 0, 1 },
+	{ 2, 1, 0 }
+};
+
+// 6 orders of stacks, times 6 orders of the columns in each of the 3 stacks
+static const uint16_t NUM_COLUMN_ORDERS = 6 * 6 * 6 * 6;
+
+// Every order of columns that keeps columns in their stacks
+struct ColumnOrders
+{
+	uint8_t orders[NUM_COLUMN_ORDERS][UNIT_SIZE];
+
+	ColumnOrders()
+	{
+		uint16_t n = 0;
+		for (uint16_t stacks = 0; stacks < 6; ++stacks)
+		{
+			for (uint16_t a = 0; a < 6; ++a)
+			{
+				for (uint16_t b = 0; b < 6; ++b)
+				{
+					for (uint16_t c = 0; c < 6; ++c)
+					{
+						const uint16_t within[3] = { a, b, c };
+						for (uint16_t k = 0; k < UNIT_SIZE; ++k)
+						{
+							orders[n][k] = (uint8_t)(3 * ORDERS_OF_THREE[stacks][k / 3] + ORDERS_OF_THREE[within[k / 3]][k % 3]);
+						}
+						++n;
+					}
+				}
+			}
+		}
+	}
+};
+
+// A partial rearrangement, with the rows of the result chosen so far
+struct Candidate
+{
+	uint8_t rows[UNIT_SIZE];
+	uint8_t digits[10];
+	uint8_t nextDigit;
+
+	// Bands the chosen rows have come from
+	uint8_t bands;
+
+	uint16_t columnOrder;
+	bool transpose;
+};
+
+// The smallest rows found for the next row of the result, and every candidate that produces them
+struct RowSearch
+{
+	uint8_t best[UNIT_SIZE];
+	std::vector<Candidate> candidates;
+
+	void reset()
+	{
+		memset(best, 0xFF, sizeof(best));
+		candidates.clear();
+	}
+};
+
+// Relabel a row in column order for a candidate, keeping the candidate if the row is no
+// bigger than the best so far
+static void tryRow(RowSearch& search, Candidate candidate, const uint8_t* row, const uint8_t* order)
+{
+	uint8_t result[UNIT_SIZE];
+	int compare = 0;
+
+	for (uint16_t k = 0; k < UNIT_SIZE; ++k)
+	{
+		uint8_t value = row[order[k]];
+		if (value != 0)
+		{
+			// Digits are numbered in the order they are first seen
+			if (candidate.digits[value] == 0)
+			{
+				candidate.digits[value] = candidate.nextDigit++;
+			}
+			value = candidate.digits[value];
+		}
+		result[k] = value;
+
+		if (compare == 0)
+		{
+			if (value > search.best[k])
+			{
+				return;
+			}
+
+			if (value < search.best[k])
+			{
+				compare = -1;
+			}
+		}
+	}
+
+	if (compare < 0)
+	{
+		memcpy(search.best, result, sizeof(result));
+		search.candidates.clear();
+	}
+
+	search.candidates.push_back(candidate);
+}
+
+// Index into ColumnOrders of the order with the given stacks and orders within them
+static uint16_t getColumnOrder(const uint8_t* stacks, const uint8_t* within)
+{
+	uint16_t stackOrder = 0;
+	while (ORDERS_OF_THREE[stackOrder][0] != stacks[0] || ORDERS_OF_THREE[stackOrder][1] != stacks[1])
+	{
+		++stackOrder;
+	}
+
+	return ((stackOrder * 6 + within[0]) * 6 + within[1]) * 6 + within[2];
+}
+
+// Search the column orders for the first row a stack at a time, dropping an order
+// as soon as its first columns are bigger than the best row so far
+static void tryFirstRow(RowSearch& search, const Candidate& candidate, const uint8_t* row,
+	uint8_t* stacks, uint8_t* within, uint16_t k, uint8_t* result)
+{
+	if (k == 3)
+	{
+		int compare = memcmp(result, search.best, UNIT_SIZE);
+		if (compare > 0)
+		{
+			return;
+		}
+
+		if (compare < 0)
+		{
+			memcpy(search.best, result, UNIT_SIZE);
+			search.candidates.clear();
+		}
+
+		search.candidates.push_back(candidate);
+		search.candidates.back().columnOrder = getColumnOrder(stacks, within);
+		return;
+	}
+
+	for (uint8_t stack = 0; stack < 3; ++stack)
+	{
+		bool used = false;
+		for (uint16_t j = 0; j < k; ++j)
+		{
+			used = used || stacks[j] == stack;
+		}
+
+		if (used)
+		{
+			continue;
+		}
+
+		for (uint8_t w = 0; w < 6; ++w)
+		{
+			Candidate extended = candidate;
+			for (uint16_t j = 0; j < 3; ++j)
+			{
+				uint8_t value = row[3 * stack + ORDERS_OF_THREE[w][j]];
+				if (value != 0)
+				{
+					if (extended.digits[value] == 0)
+					{
+						extended.digits[value] = extended.nextDigit++;
+					}
+					value = extended.digits[value];
+				}
+				result[3 * k + j] = value;
+			}
+
+			if (memcmp(result, search.best, 3 * k + 3) > 0)
+			{
+				continue;
+			}
+
+			stacks[k] = stack;
+			within[k] = w;
+			tryFirstRow(search, extended, row, stacks, within, k + 1, result);
+		}
+	}
+}
+
+void canonicalize(const uint8_t* digits, uint8_t* canonical, GridTransform* transform)
+{
+	static const ColumnOrders columnOrders;
+
+	// The puzzle as given and transposed
+	uint8_t grids[2][CELLS];
+	bool empty = true;
+	for (uint16_t i = 0; i < CELLS; ++i)
+	{
+		grids[0][i] = digits[i];
+		grids[1][i] = digits[(i % UNIT_SIZE) * UNIT_SIZE + i / UNIT_SIZE];
+		empty = empty && digits[i] == 0;
+	}
+
+	// Every rearrangement of an empty grid is the same
+	if (empty)
+	{
+		memset(canonical, 0, CELLS);
+		if (transform != NULL)
+		{
+			transform->transpose = false;
+			for (uint16_t k = 0; k < UNIT_SIZE; ++k)
+			{
+				transform->rows[k] = (uint8_t)k;
+				transform->cols[k] = (uint8_t)k;
+			}
+			for (uint16_t d = 0; d <= UNIT_SIZE; ++d)
+			{
+				transform->digits[d] = (uint8_t)d;
+			}
+		}
+		return;
+	}
+
+	RowSearch current;
+	RowSearch next;
+	current.reset();
+
+	// Every row of either grid can come first, under every column order
+	for (uint16_t t = 0; t < 2; ++t)
+	{
+		for (uint16_t r = 0; r < UNIT_SIZE; ++r)
+		{
+			Candidate candidate;
+			memset(&candidate, 0, sizeof(candidate));
+			candidate.rows[0] = (uint8_t)r;
+			candidate.nextDigit = 1;
+			candidate.bands = (uint8_t)(1 << (r / 3));
+			candidate.transpose = t != 0;
+
+			uint8_t stacks[3];
+			uint8_t within[3];
+			uint8_t result[UNIT_SIZE];
+			tryFirstRow(current, candidate, &grids[t][r * UNIT_SIZE], stacks, within, 0, result);
+		}
+	}
+	memcpy(canonical, current.best, UNIT_SIZE);
+
+	// Then extend each surviving candidate a row at a time, keeping rows in bands
+	for (uint16_t i = 1; i < UNIT_SIZE; ++i)
+	{
+		next.reset();
+
+		for (size_t c = 0; c < current.candidates.size(); ++c)
+		{
+			Candidate candidate = current.candidates[c];
+			const uint8_t* grid = grids[candidate.transpose ? 1 : 0];
+			const uint8_t* order = columnOrders.orders[candidate.columnOrder];
+
+			for (uint16_t r = 0; r < UNIT_SIZE; ++r)
+			{
+				uint16_t band = r / 3;
+				if (i % 3 == 0)
+				{
+					// Start a new band
+					if (candidate.bands & (1 << band))
+					{
+						continue;
+					}
+				}
+				else
+				{
+					// Stay in the band of the previous row, on a row not used yet
+					if (band != candidate.rows[i - 1] / 3)
+					{
+						continue;
+					}
+
+					bool used = false;
+					for (uint16_t k = i - i % 3; k < i; ++k)
+					{
+						used = used || candidate.rows[k] == r;
+					}
+
+					if (used)
+					{
+						continue;
+					}
+				}
+
+				Candidate extended = candidate;
+				extended.rows[i] = (uint8_t)r;
+				extended.bands |= (uint8_t)(1 << band);
+				tryRow(next, extended, &grid[r * UNIT_SIZE], order);
+			}
+		}
+
+		memcpy(canonical + i * UNIT_SIZE, next.best, UNIT_SIZE);
+		std::swap(current.candidates, next.candidates);
+	}
+
+	if (transform == NULL)
+	{
+		return;
+	}
+
+	// Any ties left are automorphisms of the puzzle, so the first will do
+	const Candidate& chosen = current.candidates[0];
+	transform->transpose = chosen.transpose;
+	memcpy(transform->rows, chosen.rows, sizeof(transform->rows));
+	memcpy(transform->cols, columnOrders.orders[chosen.columnOrder], sizeof(transform->cols));
+	memcpy(transform->digits, chosen.digits, sizeof(transform->digits));
+
+	// Digits missing from the puzzle take the remaining labels in order, so
+	// solutions can be mapped through the transform too
+	uint8_t nextDigit = chosen.nextDigit;
+	for (uint16_t d = 1; d <= UNIT_SIZE; ++d)
+	{
+		if (transform->digits[d] == 0)
+		{
+			transform->digits[d] = nextDigit++;
+		}
+	}
+}
+
+// Index into the input of the cell at a row and column of the (transposed) input
+static uint16_t getSourceIndex(const GridTransform& transform, uint16_t row, uint16_t col)
+{
+	return transform.transpose ? col * UNIT_SIZE + row : row * UNIT_SIZE + col;
+}
+
+// Apply a transform to 81 digits
+void applyTransform(const GridTransform& transform, const uint8_t* in, uint8_t* out)
+{
+	for (uint16_t r = 0; r < UNIT_SIZE; ++r)
+	{
+		for (uint16_t c = 0; c < UNIT_SIZE; ++c)
+		{
+			uint8_t value = in[getSourceIndex(transform, transform.rows[r], transform.cols[c])];
+			out[r * UNIT_SIZE + c] = (value == 0) ? 0 : transform.digits[value];
+		}
+	}
+}
+
+// Undo a transform, e.g. to take the solution of a canonical puzzle back to the original puzzle
+void invertTransform(const GridTransform& transform, const uint8_t* in, uint8_t* out)
+{
+	uint8_t inverse[10] = { 0 };
+	for (uint16_t d = 1; d <= UNIT_SIZE; ++d)
+	{
+		inverse[transform.digits[d]] = (uint8_t)d;
+	}
+
+	for (uint16_t r = 0; r < UNIT_SIZE; ++r)
+	{
+		for (uint16_t c = 0; c < UNIT_SIZE; ++c)
+		{
+			uint8_t value = in[r * UNIT_SIZE + c];
+			out[getSourceIndex(transform, transform.rows[r], transform.cols[c])] = inverse[value];
+		}
+	}
+}
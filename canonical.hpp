@@ -0,0 +1,39 @@
+#ifndef CANONICAL_HPP
+#define CANONICAL_HPP
+
+#include <stdint.h>
+
+// A way of rearranging and relabelling a grid that keeps it a valid sudoku:
+// optional transposition, then row and column permutations that keep rows in
+// bands and columns in stacks, then a relabelling of the digits.
+struct GridTransform
+{
+	bool transpose;
+
+	// Row r of the result is row rows[r] of the (transposed) input, likewise for columns
+	uint8_t rows[9];
+	uint8_t cols[9];
+
+	// Digit d of the input becomes digits[d] in the result, with blanks (0) left alone
+	uint8_t digits[10];
+};
+
+// Find the canonical form of a puzzle of 81 digits (0 for blanks): the
+// lexicographically smallest grid it can be turned into under the 3,359,232
+// rearrangements of the sudoku symmetry group and relabelling of its digits.
+// Puzzles that are the same up to symmetry have the same canonical form.
+// The transform taking the puzzle to its canonical form is stored in transform
+// unless it is NULL.
+//
+// Rows of the result are chosen one at a time, keeping only the partial
+// rearrangements that tie for the smallest rows so far, so this is meant for
+// puzzles. Grids with very few givens leave many ties and take much longer.
+void canonicalize(const uint8_t* digits, uint8_t* canonical, GridTransform* transform);
+
+// Apply a transform to 81 digits
+void applyTransform(const GridTransform& transform, const uint8_t* in, uint8_t* out);
+
+// Undo a transform, e.g. to take the solution of a canonical puzzle back to the original puzzle
+void invertTransform(const GridTransform& transform, const uint8_t* in, uint8_t* out);
+
+#endif
@@ -0,0 +1,276 @@
+#include "corpus.hpp"
+
+#include <string.h>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define CORPUS_SSE2
+#endif
+
+static const size_t PUZZLE_LENGTH = 81;
+
+CorpusReader::CorpusReader() :
+	mapping(NULL),
+	mappingSize(0)
+#ifdef _WIN32
+	, fileHandle(INVALID_HANDLE_VALUE),
+	mappingHandle(NULL)
+#endif
+{
+}
+
+CorpusReader::~CorpusReader()
+{
+	close();
+}
+
+const char* CorpusReader::data() const
+{
+	return mapping;
+}
+
+size_t CorpusReader::size() const
+{
+	return mappingSize;
+}
+
+#ifdef _WIN32
+
+bool CorpusReader::open(const char* path)
+{
+	close();
+
+	fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(fileHandle, &fileSize))
+	{
+		close();
+		return false;
+	}
+
+	// Empty files cannot be mapped, but are a valid (empty) corpus
+	if (fileSize.QuadPart == 0)
+	{
+		return true;
+	}
+
+	mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (mappingHandle == NULL)
+	{
+		close();
+		return false;
+	}
+
+	mapping = (const char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (mapping == NULL)
+	{
+		close();
+		return false;
+	}
+
+	mappingSize = (size_t)fileSize.QuadPart;
+	return true;
+}
+
+void CorpusReader::close()
+{
+	if (mapping != NULL)
+	{
+		UnmapViewOfFile(mapping);
+	}
+
+	if (mappingHandle != NULL)
+	{
+		CloseHandle(mappingHandle);
+	}
+
+	if (fileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(fileHandle);
+	}
+
+	mapping = NULL;
+	mappingSize = 0;
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = NULL;
+}
+
+#else
+
+bool CorpusReader::open(const char* path)
+{
+	close();
+
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	// Empty files cannot be mapped, but are a valid (empty) corpus
+	if (info.st_size == 0)
+	{
+		::close(fd);
+		return true;
+	}
+
+	void* address = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// The mapping holds its own reference to the file
+	::close(fd);
+
+	if (address == MAP_FAILED)
+	{
+		return false;
+	}
+
+	// The file is read front to back by each worker
+	madvise(address, (size_t)info.st_size, MADV_SEQUENTIAL);
+
+	mapping = (const char*)address;
+	mappingSize = (size_t)info.st_size;
+	return true;
+}
+
+void CorpusReader::close()
+{
+	if (mapping != NULL)
+	{
+		munmap((void*)mapping, mappingSize);
+	}
+
+	mapping = NULL;
+	mappingSize = 0;
+}
+
+#endif
+
+// Split the file into at most count chunks of roughly equal size, each
+// starting at the beginning of a line
+std::vector<CorpusChunk> CorpusReader::split(size_t count) const
+{
+	std::vector<CorpusChunk> chunks;
+	if (count == 0)
+	{
+		count = 1;
+	}
+
+	const char* end = mapping + mappingSize;
+	const char* begin = mapping;
+	for (size_t c = 1; c <= count && begin < end; ++c)
+	{
+		// Move each boundary forward to the start of the next line
+		const char* boundary = (c == count) ? end : mapping + mappingSize / count * c;
+		if (boundary < begin)
+		{
+			boundary = begin;
+		}
+
+		if (boundary < end)
+		{
+			const char* newline = (const char*)memchr(boundary, '\n', end - boundary);
+			boundary = (newline == NULL) ? end : newline + 1;
+		}
+
+		CorpusChunk chunk = { begin, boundary };
+		chunks.push_back(chunk);
+		begin = boundary;
+	}
+
+	return chunks;
+}
+
+// Read the next puzzle of a chunk as 81 digits (0 for blanks), moving the chunk past its line
+CorpusLine nextPuzzle(CorpusChunk& chunk, uint8_t* digits)
+{
+	while (chunk.begin < chunk.end)
+	{
+		const char* line = chunk.begin;
+		const char* newline = (const char*)memchr(line, '\n', chunk.end - line);
+		const char* lineEnd = (newline == NULL) ? chunk.end : newline;
+		chunk.begin = (newline == NULL) ? chunk.end : newline + 1;
+
+		size_t length = lineEnd - line;
+		if (length > 0 && line[length - 1] == '\r')
+		{
+			--length;
+		}
+
+		if (length == 0 || line[0] == '#')
+		{
+			continue;
+		}
+
+		if (length < PUZZLE_LENGTH || !parseDigits(line, digits))
+		{
+			return CORPUS_INVALID;
+		}
+
+		return CORPUS_PUZZLE;
+	}
+
+	return CORPUS_END;
+}
+
+// Convert 81 characters to digits, returning false if any is not a digit or '.'
+bool parseDigits(const char* text, uint8_t* digits)
+{
+	size_t i = 0;
+
+#ifdef CORPUS_SSE2
+	// 16 cells at a time: subtract '0', zero the dots, and flag anything that is not 0-9 after that
+	const __m128i zero = _mm_set1_epi8('0');
+	const __m128i dot = _mm_set1_epi8('.');
+	const __m128i nine = _mm_set1_epi8(9);
+	int invalid = 0;
+	for (; i + 16 <= PUZZLE_LENGTH; i += 16)
+	{
+		__m128i chars = _mm_loadu_si128((const __m128i*)(text + i));
+		__m128i isDot = _mm_cmpeq_epi8(chars, dot);
+		__m128i values = _mm_andnot_si128(isDot, _mm_sub_epi8(chars, zero));
+		__m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(values, nine), values);
+		invalid |= _mm_movemask_epi8(isDigit) ^ 0xFFFF;
+		_mm_storeu_si128((__m128i*)(digits + i), values);
+	}
+
+	if (invalid != 0)
+	{
+		return false;
+	}
+#endif
+
+	for (; i < PUZZLE_LENGTH; ++i)
+	{
+		uint8_t value = (text[i] == '.') ? 0 : (uint8_t)(text[i] - '0');
+		if (value > 9)
+		{
+			return false;
+		}
+
+		digits[i] = value;
+	}
+
+	return true;
+}
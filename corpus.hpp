@@ -0,0 +1,63 @@
+#ifndef CORPUS_HPP
+#define CORPUS_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// A run of whole lines of a corpus file, handed to one worker
+struct CorpusChunk
+{
+	const char* begin;
+	const char* end;
+};
+
+// A puzzle corpus of 81 character lines ('1'-'9' givens, '0' or '.' blanks),
+// mapped into memory rather than read so multi-gigabyte files are never copied.
+// Blank lines and lines starting with '#' are skipped, and anything after the
+// first 81 characters of a line is ignored.
+class CorpusReader
+{
+public:
+	CorpusReader();
+	~CorpusReader();
+
+	CorpusReader(const CorpusReader&) = delete;
+	CorpusReader& operator=(const CorpusReader&) = delete;
+
+	// Map a file, returning false if it could not be opened or mapped
+	bool open(const char* path);
+	void close();
+
+	const char* data() const;
+	size_t size() const;
+
+	// Split the file into at most count chunks of roughly equal size, each
+	// starting at the beginning of a line
+	std::vector<CorpusChunk> split(size_t count) const;
+
+private:
+	const char* mapping;
+	size_t mappingSize;
+
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#endif
+};
+
+// Results of reading the next puzzle from a chunk
+enum CorpusLine
+{
+	CORPUS_END,
+	CORPUS_PUZZLE,
+	CORPUS_INVALID
+};
+
+// Read the next puzzle of a chunk as 81 digits (0 for blanks), moving the chunk past its line
+CorpusLine nextPuzzle(CorpusChunk& chunk, uint8_t* digits);
+
+// Convert 81 characters to digits, returning false if any is not a digit or '.'
+bool parseDigits(const char* text, uint8_t* digits);
+
+#endif
@@ -0,0 +1,168 @@
+#include "metrics.hpp"
+
+#include <string.h>
+
+// QQWING technique counts, in the order they are written
+static const uint16_t NUM_QQWING_COUNTS = 9;
+
+static const char* QQWING_COUNT_NAMES[NUM_QQWING_COUNTS] =
+{
+	"givens",
+	"singles",
+	"hidden_singles",
+	"naked_pairs",
+	"hidden_pairs",
+	"pointing_pairs_triples",
+	"box_line_reductions",
+	"guesses",
+	"backtracks"
+};
+
+static void getQqwingCounts(const SolveMetrics& metrics, int counts[NUM_QQWING_COUNTS])
+{
+	counts[0] = metrics.givenCount;
+	counts[1] = metrics.singleCount;
+	counts[2] = metrics.hiddenSingleCount;
+	counts[3] = metrics.nakedPairCount;
+	counts[4] = metrics.hiddenPairCount;
+	counts[5] = metrics.pointingPairTripleCount;
+	counts[6] = metrics.boxLineReductionCount;
+	counts[7] = metrics.guessCount;
+	counts[8] = metrics.backtrackCount;
+}
+
+// Write a technique name as a lower case identifier, e.g. "Naked Rows" as "naked_rows"
+static void writeIdentifier(std::ostream& out, const char* name)
+{
+	for (const char* c = name; *c != '\0'; ++c)
+	{
+		if (*c == ' ')
+		{
+			out << '_';
+		}
+		else if (*c >= 'A' && *c <= 'Z')
+		{
+			out << (char)(*c - 'A' + 'a');
+		}
+		else
+		{
+			out << *c;
+		}
+	}
+}
+
+// Write a CSV column name for one statistic of a technique, e.g. ",naked_rows_hits"
+static void writeTechniqueColumn(std::ostream& out, const char* name, const char* statistic)
+{
+	out << ',';
+	writeIdentifier(out, name);
+	out << '_' << statistic;
+}
+
+MetricsFormat parseMetricsFormat(const char* name)
+{
+	if (strcmp(name, "json") == 0)
+	{
+		return METRICS_JSON;
+	}
+	if (strcmp(name, "csv") == 0)
+	{
+		return METRICS_CSV;
+	}
+
+	return METRICS_NONE;
+}
+
+void writeMetricsHeader(std::ostream& out, MetricsFormat format, const SolveMetrics& metrics)
+{
+	if (format != METRICS_CSV)
+	{
+		return;
+	}
+
+	out << "index,puzzle,difficulty,result,missed,time_ns,reads,writes";
+
+	for (uint16_t i = 0; i < NUM_QQWING_COUNTS; ++i)
+	{
+		out << ",qqwing_" << QQWING_COUNT_NAMES[i];
+	}
+
+	for (uint16_t t = 0; t < metrics.numTechniques; ++t)
+	{
+		const char* name = metrics.techniques[t].name;
+		writeTechniqueColumn(out, name, "calls");
+		writeTechniqueColumn(out, name, "hits");
+		writeTechniqueColumn(out, name, "writes");
+		writeTechniqueColumn(out, name, "time_ns");
+	}
+
+	out << '\n';
+}
+
+void writeMetrics(std::ostream& out, MetricsFormat format, const SolveMetrics& metrics)
+{
+	int counts[NUM_QQWING_COUNTS];
+	getQqwingCounts(metrics, counts);
+
+	const char* result = metrics.passed ? "pass" : "fail";
+
+	if (format == METRICS_JSON)
+	{
+		out << "{\"index\":" << metrics.index
+			<< ",\"puzzle\":\"" << metrics.puzzle << '"'
+			<< ",\"difficulty\":\"" << metrics.difficulty << '"'
+			<< ",\"result\":\"" << result << '"'
+			<< ",\"missed\":" << metrics.numMissed
+			<< ",\"time_ns\":" << metrics.timeNs
+			<< ",\"reads\":" << metrics.reads
+			<< ",\"writes\":" << metrics.writes
+			<< ",\"qqwing\":{";
+
+		for (uint16_t i = 0; i < NUM_QQWING_COUNTS; ++i)
+		{
+			out << (i == 0 ? "\"" : ",\"") << QQWING_COUNT_NAMES[i] << "\":" << counts[i];
+		}
+
+		out << "},\"techniques\":{";
+
+		for (uint16_t t = 0; t < metrics.numTechniques; ++t)
+		{
+			const TechniqueMetrics& technique = metrics.techniques[t];
+			out << (t == 0 ? "\"" : ",\"");
+			writeIdentifier(out, technique.name);
+			out << "\":{\"calls\":" << technique.calls
+				<< ",\"hits\":" << technique.hits
+				<< ",\"writes\":" << technique.writes
+				<< ",\"time_ns\":" << technique.timeNs << '}';
+		}
+
+		out << "}}\n";
+	}
+	else if (format == METRICS_CSV)
+	{
+		out << metrics.index
+			<< ',' << metrics.puzzle
+			<< ',' << metrics.difficulty
+			<< ',' << result
+			<< ',' << metrics.numMissed
+			<< ',' << metrics.timeNs
+			<< ',' << metrics.reads
+			<< ',' << metrics.writes;
+
+		for (uint16_t i = 0; i < NUM_QQWING_COUNTS; ++i)
+		{
+			out << ',' << counts[i];
+		}
+
+		for (uint16_t t = 0; t < metrics.numTechniques; ++t)
+		{
+			const TechniqueMetrics& technique = metrics.techniques[t];
+			out << ',' << technique.calls
+				<< ',' << technique.hits
+				<< ',' << technique.writes
+				<< ',' << technique.timeNs;
+		}
+
+		out << '\n';
+	}
+}
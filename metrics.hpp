@@ -0,0 +1,71 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <iostream>
+#include <stdint.h>
+#include <string>
+
+static const uint16_t MAX_METRIC_TECHNIQUES = 32;
+
+// Machine readable output formats for per-puzzle metrics
+enum MetricsFormat
+{
+	METRICS_NONE,
+	METRICS_JSON,
+	METRICS_CSV
+};
+
+// Statistics for one solving technique over one solve
+struct TechniqueMetrics
+{
+	const char* name;
+	uint64_t calls;
+	uint64_t hits;
+	uint64_t writes;
+	uint64_t timeNs;
+};
+
+// Everything recorded about solving one puzzle
+struct SolveMetrics
+{
+	uint32_t index;
+
+	// The givens as 81 characters, '.' for blanks
+	char puzzle[82];
+
+	std::string difficulty;
+
+	// Whether the solver matched the QQWING solution, and how many cells it missed
+	bool passed;
+	uint16_t numMissed;
+
+	uint64_t timeNs;
+	uint64_t reads;
+	uint64_t writes;
+
+	// QQWING technique counts
+	int givenCount;
+	int singleCount;
+	int hiddenSingleCount;
+	int nakedPairCount;
+	int hiddenPairCount;
+	int pointingPairTripleCount;
+	int boxLineReductionCount;
+	int guessCount;
+	int backtrackCount;
+
+	// Solver technique counts
+	uint16_t numTechniques;
+	TechniqueMetrics techniques[MAX_METRIC_TECHNIQUES];
+};
+
+// Parse a format name ("json" or "csv"), returning METRICS_NONE if it is not recognised
+MetricsFormat parseMetricsFormat(const char* name);
+
+// Write the CSV column names (JSON has no header)
+void writeMetricsHeader(std::ostream& out, MetricsFormat format, const SolveMetrics& metrics);
+
+// Write one record, as a single line
+void writeMetrics(std::ostream& out, MetricsFormat format, const SolveMetrics& metrics);
+
+#endif
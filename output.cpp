@@ -0,0 +1,100 @@
+#include "output.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+static bool outputEnabled = true;
+
+OutputBuffer::OutputBuffer(size_t capacity) :
+	buffer(capacity == 0 ? 1 : capacity),
+	size(0)
+{
+}
+
+void OutputBuffer::put(const char* text)
+{
+	put(text, strlen(text));
+}
+
+void OutputBuffer::put(const char* text, size_t length)
+{
+	while (length > 0)
+	{
+		if (size == buffer.size())
+		{
+			flush();
+		}
+
+		size_t count = buffer.size() - size;
+		if (count > length)
+		{
+			count = length;
+		}
+
+		memcpy(&buffer[size], text, count);
+		size += count;
+		text += count;
+		length -= count;
+	}
+}
+
+// Write a number right aligned to width characters, padded with fill
+void OutputBuffer::putNumber(int64_t value, uint16_t width, char fill)
+{
+	char digits[24];
+	uint16_t length = 0;
+
+	uint64_t magnitude = (value < 0) ? 0 - (uint64_t)value : (uint64_t)value;
+	do
+	{
+		digits[length++] = (char)('0' + magnitude % 10);
+		magnitude /= 10;
+	} while (magnitude != 0);
+
+	if (value < 0)
+	{
+		digits[length++] = '-';
+	}
+
+	for (uint16_t i = length; i < width; ++i)
+	{
+		put(fill);
+	}
+
+	while (length > 0)
+	{
+		put(digits[--length]);
+	}
+}
+
+// Write out everything buffered with a single write and empty the buffer
+void OutputBuffer::flush()
+{
+	if (size == 0)
+	{
+		return;
+	}
+
+	// Going through stdout keeps the order of anything written with std::cout,
+	// which is synchronised with it
+	fwrite(buffer.data(), 1, size, stdout);
+	fflush(stdout);
+	size = 0;
+}
+
+// The output buffer for stdout, one per thread so threads never share a buffer
+OutputBuffer& getOutputBuffer()
+{
+	static thread_local OutputBuffer output;
+	return output;
+}
+
+void setOutputEnabled(bool enabled)
+{
+	outputEnabled = enabled;
+}
+
+bool isOutputEnabled()
+{
+	return outputEnabled;
+}
@@ -0,0 +1,48 @@
+#ifndef OUTPUT_HPP
+#define OUTPUT_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+static const size_t OUTPUT_BUFFER_SIZE = 1 << 16;
+
+// A preallocated buffer that whole boards and histories are formatted into,
+// then written to stdout in one go rather than a character at a time.
+// Anything still buffered is written out if the buffer fills up.
+class OutputBuffer
+{
+public:
+	explicit OutputBuffer(size_t capacity = OUTPUT_BUFFER_SIZE);
+
+	void put(char c)
+	{
+		if (size == buffer.size())
+		{
+			flush();
+		}
+		buffer[size++] = c;
+	}
+
+	void put(const char* text);
+	void put(const char* text, size_t length);
+
+	// Write a number right aligned to width characters, padded with fill
+	void putNumber(int64_t value, uint16_t width = 0, char fill = ' ');
+
+	// Write out everything buffered with a single write and empty the buffer
+	void flush();
+
+private:
+	std::vector<char> buffer;
+	size_t size;
+};
+
+// The output buffer for stdout, one per thread so threads never share a buffer
+OutputBuffer& getOutputBuffer();
+
+// Turn board and history printing off altogether, e.g. for benchmarks
+void setOutputEnabled(bool enabled);
+bool isOutputEnabled();
+
+#endif
@@ -0,0 +1,184 @@
+#include "overlay.hpp"
+
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define OVERLAY_SSE2
+#endif
+
+static const uint16_t GRID_SIZE = 9;
+static const uint16_t BOX_SIZE = 3;
+
+// Every placement of a digit once in each row, column and box
+static const uint32_t NUM_PLACEMENTS = 46656;
+
+// Placements sharing the same cells in the first band (9 * 6 * 3 of those) and
+// then in the first two bands (another 6 * 4 * 2 below each)
+static const uint32_t PLACEMENTS_PER_BAND0 = NUM_PLACEMENTS / 162;
+static const uint32_t PLACEMENTS_PER_BAND1 = PLACEMENTS_PER_BAND0 / 48;
+
+// The first two bands are cells 0-53, so both fit in the first word
+static const uint64_t BAND0_BITS = (1ull << 27) - 1;
+static const uint64_t BAND1_BITS = ((1ull << 54) - 1) & ~BAND0_BITS;
+
+void addCell(CellSet& cells, uint16_t idx)
+{
+	cells.words[idx / 64] |= 1ull << (idx % 64);
+}
+
+bool hasCell(const CellSet& cells, uint16_t idx)
+{
+	return ((cells.words[idx / 64] >> (idx % 64)) & 0x1) != 0;
+}
+
+// Place the digit in each row from row onwards, in a column and box not used yet
+static void addPlacements(std::vector<CellSet>& placements, CellSet cells, uint16_t row, uint16_t usedCols)
+{
+	if (row == GRID_SIZE)
+	{
+		placements.push_back(cells);
+		return;
+	}
+
+	for (uint16_t col = 0; col < GRID_SIZE; ++col)
+	{
+		if ((usedCols >> col) & 0x1)
+		{
+			continue;
+		}
+
+		// Skip over columns sharing a box with a placement earlier in this band
+		bool sameBox = false;
+		for (uint16_t r = row - row % BOX_SIZE; r < row; ++r)
+		{
+			for (uint16_t c = col - col % BOX_SIZE; c < col - col % BOX_SIZE + BOX_SIZE; ++c)
+			{
+				if (hasCell(cells, r * GRID_SIZE + c))
+				{
+					sameBox = true;
+				}
+			}
+		}
+
+		if (sameBox)
+		{
+			continue;
+		}
+
+		CellSet next = cells;
+		addCell(next, row * GRID_SIZE + col);
+		addPlacements(placements, next, row + 1, usedCols | (1 << col));
+	}
+}
+
+// Generated depth first, so placements sharing their first rows stay together
+static std::vector<CellSet> generatePlacements()
+{
+	std::vector<CellSet> placements;
+	placements.reserve(NUM_PLACEMENTS);
+	addPlacements(placements, CellSet(), 0, 0);
+
+	return placements;
+}
+
+// Shared by every thread, and generated by whichever needs them first
+static const std::vector<CellSet>& getPlacements()
+{
+	static const std::vector<CellSet> placements = generatePlacements();
+
+	return placements;
+}
+
+// Check whether the part of a placement in some of the first 54 cells fits
+static bool fitsBands(uint64_t placement, uint64_t allowed, uint64_t required, uint64_t bands)
+{
+	placement &= bands;
+
+	return (placement & ~allowed) == 0 && (required & bands & ~placement) == 0;
+}
+
+uint32_t overlayPlacements(const CellSet& allowed, const CellSet& required, CellSet& anyCells, CellSet& allCells)
+{
+	const std::vector<CellSet>& placements = getPlacements();
+	uint32_t count = 0;
+
+#ifdef OVERLAY_SSE2
+	const __m128i allowedBits = _mm_loadu_si128((const __m128i*)allowed.words);
+	const __m128i requiredBits = _mm_loadu_si128((const __m128i*)required.words);
+	const __m128i zero = _mm_setzero_si128();
+	__m128i any = zero;
+	__m128i all = _mm_cmpeq_epi8(zero, zero);
+#else
+	CellSet any = { { 0, 0 } };
+	CellSet all = { { ~0ull, ~0ull } };
+#endif
+
+	for (uint32_t band0 = 0; band0 < NUM_PLACEMENTS; band0 += PLACEMENTS_PER_BAND0)
+	{
+		if (!fitsBands(placements[band0].words[0], allowed.words[0], required.words[0], BAND0_BITS))
+		{
+			continue;
+		}
+
+		for (uint32_t band1 = band0; band1 < band0 + PLACEMENTS_PER_BAND0; band1 += PLACEMENTS_PER_BAND1)
+		{
+			if (!fitsBands(placements[band1].words[0], allowed.words[0], required.words[0], BAND1_BITS))
+			{
+				continue;
+			}
+
+			// The last band is checked for the whole placement at once
+			for (uint32_t p = band1; p < band1 + PLACEMENTS_PER_BAND1; ++p)
+			{
+#ifdef OVERLAY_SSE2
+				__m128i placement = _mm_loadu_si128((const __m128i*)placements[p].words);
+				__m128i misfit = _mm_or_si128(_mm_andnot_si128(allowedBits, placement),
+					_mm_andnot_si128(placement, requiredBits));
+				if (_mm_movemask_epi8(_mm_cmpeq_epi8(misfit, zero)) != 0xFFFF)
+				{
+					continue;
+				}
+
+				any = _mm_or_si128(any, placement);
+				all = _mm_and_si128(all, placement);
+#else
+				const CellSet& placement = placements[p];
+				bool fits = true;
+				for (uint16_t w = 0; w < 2; ++w)
+				{
+					fits = fits && (placement.words[w] & ~allowed.words[w]) == 0 &&
+						(required.words[w] & ~placement.words[w]) == 0;
+				}
+
+				if (!fits)
+				{
+					continue;
+				}
+
+				for (uint16_t w = 0; w < 2; ++w)
+				{
+					any.words[w] |= placement.words[w];
+					all.words[w] &= placement.words[w];
+				}
+#endif
+				++count;
+			}
+		}
+	}
+
+#ifdef OVERLAY_SSE2
+	_mm_storeu_si128((__m128i*)anyCells.words, any);
+	_mm_storeu_si128((__m128i*)allCells.words, all);
+#else
+	anyCells = any;
+	allCells = all;
+#endif
+
+	if (count == 0)
+	{
+		allCells = CellSet();
+	}
+
+	return count;
+}
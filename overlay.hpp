@@ -0,0 +1,28 @@
+#ifndef OVERLAY_HPP
+#define OVERLAY_HPP
+
+#include <stdint.h>
+
+// A set of cells of the grid, cell i being bit i % 64 of words[i / 64]
+struct CellSet
+{
+	uint64_t words[2];
+};
+
+// Add a cell to a set, or check whether it is in one
+void addCell(CellSet& cells, uint16_t idx);
+bool hasCell(const CellSet& cells, uint16_t idx);
+
+// Overlay the 46,656 ways of placing one digit once in every row, column and box
+// on a grid. Only placements covering every cell of required and nothing outside
+// of allowed fit. The cells in any fitting placement are returned in anyCells,
+// and those in every one of them in allCells.
+//
+// The placements are generated the first time this is called, as 128 bit sets
+// ordered so that placements sharing their first and second bands are next to
+// each other, letting whole runs of them be ruled out at once.
+//
+// Returns the number of placements that fit, 0 if none do (a contradiction).
+uint32_t overlayPlacements(const CellSet& allowed, const CellSet& required, CellSet& anyCells, CellSet& allCells);
+
+#endif
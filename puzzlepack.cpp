@@ -0,0 +1,389 @@
+#include "puzzlepack.hpp"
+
+#include <string.h>
+
+static const char PACK_MAGIC[4] = { 'S', 'D', 'K', 'P' };
+static const uint16_t PACK_VERSION = 1;
+static const uint16_t PUZZLE_CELLS = 81;
+
+static void putU16(uint8_t* out, uint16_t value)
+{
+	out[0] = (uint8_t)value;
+	out[1] = (uint8_t)(value >> 8);
+}
+
+static void putU32(uint8_t* out, uint32_t value)
+{
+	putU16(out, (uint16_t)value);
+	putU16(out + 2, (uint16_t)(value >> 16));
+}
+
+static void putU64(uint8_t* out, uint64_t value)
+{
+	putU32(out, (uint32_t)value);
+	putU32(out + 4, (uint32_t)(value >> 32));
+}
+
+static uint16_t getU16(const uint8_t* in)
+{
+	return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static uint32_t getU32(const uint8_t* in)
+{
+	return getU16(in) | ((uint32_t)getU16(in + 2) << 16);
+}
+
+static uint64_t getU64(const uint8_t* in)
+{
+	return getU32(in) | ((uint64_t)getU32(in + 4) << 32);
+}
+
+// Byte at a time CRC-32 table for the reflected polynomial 0xEDB88320
+struct CrcTable
+{
+	uint32_t entries[256];
+
+	CrcTable()
+	{
+		for (uint32_t n = 0; n < 256; ++n)
+		{
+			uint32_t c = n;
+			for (int k = 0; k < 8; ++k)
+			{
+				c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+			}
+			entries[n] = c;
+		}
+	}
+};
+
+// CRC-32 (as used by zlib) of a run of bytes, continuing from an earlier crc
+uint32_t packChecksum(const uint8_t* data, size_t length, uint32_t crc)
+{
+	static const CrcTable table;
+
+	crc = ~crc;
+	for (size_t i = 0; i < length; ++i)
+	{
+		crc = table.entries[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+
+	return ~crc;
+}
+
+PackWriter::PackWriter() :
+	puzzlesPerBlock(PACK_DEFAULT_BLOCK_PUZZLES),
+	puzzleCount(0),
+	offset(0)
+{
+}
+
+PackWriter::~PackWriter()
+{
+	if (file.is_open())
+	{
+		close();
+	}
+}
+
+bool PackWriter::open(const char* path, uint32_t blockPuzzles)
+{
+	file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	puzzlesPerBlock = (blockPuzzles == 0) ? PACK_DEFAULT_BLOCK_PUZZLES : blockPuzzles;
+	puzzleCount = 0;
+	offset = PACK_HEADER_SIZE;
+	block.clear();
+	block.reserve((size_t)puzzlesPerBlock * PACK_PUZZLE_SIZE);
+	blocks.clear();
+
+	// The header is filled in once the index has been written
+	uint8_t header[PACK_HEADER_SIZE] = { 0 };
+	file.write((const char*)header, PACK_HEADER_SIZE);
+
+	return file.good();
+}
+
+// Add a puzzle given as 81 digits (0 for blanks)
+bool PackWriter::write(const uint8_t* digits)
+{
+	uint8_t packed[PACK_PUZZLE_SIZE];
+	for (uint16_t i = 0; i + 1 < PUZZLE_CELLS; i += 2)
+	{
+		packed[i / 2] = (uint8_t)(digits[i] | (digits[i + 1] << 4));
+	}
+	packed[PUZZLE_CELLS / 2] = digits[PUZZLE_CELLS - 1];
+
+	block.insert(block.end(), packed, packed + PACK_PUZZLE_SIZE);
+	++puzzleCount;
+
+	if (block.size() == (size_t)puzzlesPerBlock * PACK_PUZZLE_SIZE)
+	{
+		return flushBlock();
+	}
+
+	return true;
+}
+
+bool PackWriter::flushBlock()
+{
+	if (block.empty())
+	{
+		return true;
+	}
+
+	BlockEntry entry;
+	entry.offset = offset;
+	entry.puzzles = (uint32_t)(block.size() / PACK_PUZZLE_SIZE);
+	entry.crc = packChecksum(block.data(), block.size());
+	blocks.push_back(entry);
+
+	file.write((const char*)block.data(), block.size());
+	offset += block.size();
+	block.clear();
+
+	return file.good();
+}
+
+// Write the block index and header, returning false if anything failed to write
+bool PackWriter::close()
+{
+	flushBlock();
+
+	std::vector<uint8_t> index(blocks.size() * PACK_INDEX_ENTRY_SIZE);
+	for (size_t b = 0; b < blocks.size(); ++b)
+	{
+		uint8_t* entry = &index[b * PACK_INDEX_ENTRY_SIZE];
+		putU64(entry, blocks[b].offset);
+		putU32(entry + 8, blocks[b].puzzles);
+		putU32(entry + 12, blocks[b].crc);
+	}
+	file.write((const char*)index.data(), index.size());
+
+	uint8_t header[PACK_HEADER_SIZE];
+	memcpy(header, PACK_MAGIC, sizeof(PACK_MAGIC));
+	putU16(header + 4, PACK_VERSION);
+	putU16(header + 6, PACK_PUZZLE_SIZE);
+	putU32(header + 8, puzzlesPerBlock);
+	putU32(header + 12, (uint32_t)blocks.size());
+	putU64(header + 16, puzzleCount);
+	putU64(header + 24, offset);
+	putU32(header + 32, packChecksum(index.data(), index.size()));
+	putU32(header + 36, packChecksum(header, 36));
+
+	file.seekp(0);
+	file.write((const char*)header, PACK_HEADER_SIZE);
+
+	bool good = file.good();
+	file.close();
+	return good;
+}
+
+PackReader::PackReader() :
+	index(NULL),
+	numBlocks(0),
+	numPuzzles(0)
+{
+}
+
+// Map a file and check its header and block index, returning false if it
+// is not a packed file or is damaged
+bool PackReader::open(const char* path)
+{
+	close();
+
+	if (!file.open(path) || file.size() < PACK_HEADER_SIZE)
+	{
+		close();
+		return false;
+	}
+
+	const uint8_t* header = (const uint8_t*)file.data();
+	if (memcmp(header, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 ||
+		getU16(header + 4) != PACK_VERSION ||
+		getU16(header + 6) != PACK_PUZZLE_SIZE ||
+		getU32(header + 36) != packChecksum(header, 36))
+	{
+		close();
+		return false;
+	}
+
+	uint32_t blocks = getU32(header + 12);
+	uint64_t puzzles = getU64(header + 16);
+	uint64_t indexOffset = getU64(header + 24);
+	uint64_t indexSize = (uint64_t)blocks * PACK_INDEX_ENTRY_SIZE;
+
+	if (indexOffset > file.size() || indexSize > file.size() - indexOffset ||
+		getU32(header + 32) != packChecksum(header + indexOffset, (size_t)indexSize))
+	{
+		close();
+		return false;
+	}
+
+	// Every block has to lie between the header and the index, and the blocks have to add up
+	uint64_t total = 0;
+	for (uint32_t b = 0; b < blocks; ++b)
+	{
+		const uint8_t* entry = header + indexOffset + (uint64_t)b * PACK_INDEX_ENTRY_SIZE;
+		uint64_t blockOffset = getU64(entry);
+		uint64_t blockSize = (uint64_t)getU32(entry + 8) * PACK_PUZZLE_SIZE;
+		if (blockOffset < PACK_HEADER_SIZE || blockOffset > indexOffset || blockSize > indexOffset - blockOffset)
+		{
+			close();
+			return false;
+		}
+
+		total += getU32(entry + 8);
+	}
+
+	if (total != puzzles)
+	{
+		close();
+		return false;
+	}
+
+	index = header + indexOffset;
+	numBlocks = blocks;
+	numPuzzles = puzzles;
+	return true;
+}
+
+void PackReader::close()
+{
+	file.close();
+	index = NULL;
+	numBlocks = 0;
+	numPuzzles = 0;
+}
+
+uint64_t PackReader::puzzleCount() const
+{
+	return numPuzzles;
+}
+
+uint32_t PackReader::blockCount() const
+{
+	return numBlocks;
+}
+
+uint32_t PackReader::blockPuzzleCount(uint32_t block) const
+{
+	return getU32(index + (uint64_t)block * PACK_INDEX_ENTRY_SIZE + 8);
+}
+
+const uint8_t* PackReader::getBlock(uint32_t block) const
+{
+	return (const uint8_t*)file.data() + getU64(index + (uint64_t)block * PACK_INDEX_ENTRY_SIZE);
+}
+
+// Check the contents of a block against its checksum
+bool PackReader::verifyBlock(uint32_t block) const
+{
+	uint32_t crc = getU32(index + (uint64_t)block * PACK_INDEX_ENTRY_SIZE + 12);
+	return packChecksum(getBlock(block), (size_t)blockPuzzleCount(block) * PACK_PUZZLE_SIZE) == crc;
+}
+
+// Unpack one puzzle of a block as 81 digits (0 for blanks)
+void PackReader::readPuzzle(uint32_t block, uint32_t puzzle, uint8_t* digits) const
+{
+	const uint8_t* packed = getBlock(block) + (size_t)puzzle * PACK_PUZZLE_SIZE;
+	for (uint16_t i = 0; i + 1 < PUZZLE_CELLS; i += 2)
+	{
+		digits[i] = packed[i / 2] & 0x0F;
+		digits[i + 1] = packed[i / 2] >> 4;
+	}
+	digits[PUZZLE_CELLS - 1] = packed[PUZZLE_CELLS / 2] & 0x0F;
+}
+
+// Check whether a file starts with the packed format magic
+bool isPackFile(const char* path)
+{
+	char magic[sizeof(PACK_MAGIC)];
+	std::ifstream in(path, std::ios::in | std::ios::binary);
+	return in.read(magic, sizeof(magic)) && memcmp(magic, PACK_MAGIC, sizeof(PACK_MAGIC)) == 0;
+}
+
+// Convert a text corpus to a packed file, skipping invalid lines
+bool packCorpus(const char* textPath, const char* packPath, uint64_t& puzzleCount, uint64_t& invalidCount)
+{
+	puzzleCount = 0;
+	invalidCount = 0;
+
+	CorpusReader reader;
+	PackWriter writer;
+	if (!reader.open(textPath) || !writer.open(packPath))
+	{
+		return false;
+	}
+
+	CorpusChunk chunk = { reader.data(), reader.data() + reader.size() };
+	uint8_t digits[PUZZLE_CELLS];
+
+	CorpusLine line;
+	while ((line = nextPuzzle(chunk, digits)) != CORPUS_END)
+	{
+		if (line == CORPUS_INVALID)
+		{
+			++invalidCount;
+			continue;
+		}
+
+		if (!writer.write(digits))
+		{
+			return false;
+		}
+		++puzzleCount;
+	}
+
+	return writer.close();
+}
+
+// Convert a packed file to a text corpus of 81 character lines, with '.' for blanks
+bool unpackCorpus(const char* packPath, const char* textPath, uint64_t& puzzleCount)
+{
+	puzzleCount = 0;
+
+	PackReader reader;
+	if (!reader.open(packPath))
+	{
+		return false;
+	}
+
+	std::ofstream out(textPath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!out.is_open())
+	{
+		return false;
+	}
+
+	uint8_t digits[PUZZLE_CELLS];
+	char line[PUZZLE_CELLS + 1];
+	line[PUZZLE_CELLS] = '\n';
+
+	for (uint32_t b = 0; b < reader.blockCount(); ++b)
+	{
+		if (!reader.verifyBlock(b))
+		{
+			return false;
+		}
+
+		for (uint32_t p = 0; p < reader.blockPuzzleCount(b); ++p)
+		{
+			reader.readPuzzle(b, p, digits);
+			for (uint16_t i = 0; i < PUZZLE_CELLS; ++i)
+			{
+				line[i] = (digits[i] == 0) ? '.' : (char)('0' + digits[i]);
+			}
+
+			out.write(line, sizeof(line));
+			++puzzleCount;
+		}
+	}
+
+	out.close();
+	return out.good();
+}
@@ -0,0 +1,118 @@
+#ifndef PUZZLEPACK_HPP
+#define PUZZLEPACK_HPP
+
+#include <fstream>
+#include <stdint.h>
+#include <vector>
+
+#include "corpus.hpp"
+
+// A compact binary container for puzzle corpora, about half the size of the
+// 81 character text format and loaded without any parsing.
+//
+// All integers are little endian.
+//
+// Header (40 bytes)
+//    0  char[4]  magic "SDKP"
+//    4  uint16   format version (1)
+//    6  uint16   bytes per puzzle (41)
+//    8  uint32   puzzles per block, the last block may hold fewer
+//   12  uint32   block count
+//   16  uint64   puzzle count
+//   24  uint64   offset of the block index
+//   32  uint32   CRC-32 of the block index
+//   36  uint32   CRC-32 of header bytes 0-35
+//
+// Blocks follow the header, each a run of puzzles of 41 bytes. Cell i of a
+// puzzle is in the low nibble of byte i / 2 when i is even and the high nibble
+// when it is odd, holding 1-9 or 0 for a blank.
+//
+// The block index has one 16 byte entry per block
+//    0  uint64   offset of the block
+//    8  uint32   puzzles in the block
+//   12  uint32   CRC-32 of the block
+
+static const uint32_t PACK_HEADER_SIZE = 40;
+static const uint32_t PACK_INDEX_ENTRY_SIZE = 16;
+static const uint32_t PACK_PUZZLE_SIZE = 41;
+static const uint32_t PACK_DEFAULT_BLOCK_PUZZLES = 4096;
+
+// Writes puzzles to a new packed file one at a time
+class PackWriter
+{
+public:
+	PackWriter();
+	~PackWriter();
+
+	PackWriter(const PackWriter&) = delete;
+	PackWriter& operator=(const PackWriter&) = delete;
+
+	bool open(const char* path, uint32_t puzzlesPerBlock = PACK_DEFAULT_BLOCK_PUZZLES);
+
+	// Add a puzzle given as 81 digits (0 for blanks)
+	bool write(const uint8_t* digits);
+
+	// Write the block index and header, returning false if anything failed to write
+	bool close();
+
+private:
+	struct BlockEntry
+	{
+		uint64_t offset;
+		uint32_t puzzles;
+		uint32_t crc;
+	};
+
+	bool flushBlock();
+
+	std::ofstream file;
+	uint32_t puzzlesPerBlock;
+	uint64_t puzzleCount;
+	uint64_t offset;
+	std::vector<uint8_t> block;
+	std::vector<BlockEntry> blocks;
+};
+
+// Reads a packed file mapped into memory
+class PackReader
+{
+public:
+	PackReader();
+
+	// Map a file and check its header and block index, returning false if it
+	// is not a packed file or is damaged
+	bool open(const char* path);
+	void close();
+
+	uint64_t puzzleCount() const;
+	uint32_t blockCount() const;
+	uint32_t blockPuzzleCount(uint32_t block) const;
+
+	// Check the contents of a block against its checksum
+	bool verifyBlock(uint32_t block) const;
+
+	// Unpack one puzzle of a block as 81 digits (0 for blanks)
+	void readPuzzle(uint32_t block, uint32_t puzzle, uint8_t* digits) const;
+
+private:
+	const uint8_t* getBlock(uint32_t block) const;
+
+	CorpusReader file;
+	const uint8_t* index;
+	uint32_t numBlocks;
+	uint64_t numPuzzles;
+};
+
+// Check whether a file starts with the packed format magic
+bool isPackFile(const char* path);
+
+// Convert a text corpus to a packed file, skipping invalid lines
+bool packCorpus(const char* textPath, const char* packPath, uint64_t& puzzleCount, uint64_t& invalidCount);
+
+// Convert a packed file to a text corpus of 81 character lines, with '.' for blanks
+bool unpackCorpus(const char* packPath, const char* textPath, uint64_t& puzzleCount);
+
+// CRC-32 (as used by zlib) of a run of bytes, continuing from an earlier crc
+uint32_t packChecksum(const uint8_t* data, size_t length, uint32_t crc = 0);
+
+#endif
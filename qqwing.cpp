@@ -19,9 +19,18 @@
  * with this program; if not, write to the Free Software Foundation, Inc.,
  * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
+#include <atomic>
 #include <cstdlib>
+#include <deque>
 #include <iostream>
+#include <mutex>
+#include <thread>
 
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+#include "output.hpp"
 #include "qqwing.hpp"
 
 namespace qqwing {
@@ -60,7 +69,7 @@ namespace qqwing {
 			LogItem(int round, LogType type);
 			LogItem(int round, LogType type, int value, int position);
 			int getRound();
-			void print();
+			void print(OutputBuffer& out);
 			LogType getType();
 			~LogItem();
 		private:
@@ -89,6 +98,100 @@ namespace qqwing {
 			int position;
 	};
 
+	/**
+	 * A piece of parallel counting work: a copy of the
+	 * board taken right after a guess, and the round in
+	 * which that guess was made.
+	 */
+	class SearchTask {
+		public:
+			SearchTask();
+			SearchTask(SudokuBoard* board, int round);
+			SudokuBoard* board;
+			int round;
+	};
+
+	/**
+	 * One level of a resumable solve: the round its moves
+	 * are made in, and once no more moves can be made by
+	 * logic, the next guess to try (in round+1, with the
+	 * moves following it in round+2).
+	 */
+	class SolveFrame {
+		public:
+			SolveFrame(int round);
+			int round;
+			int guessNumber;
+			bool guessing;
+	};
+
+	/**
+	 * One queue of search tasks per worker thread.  A worker
+	 * takes tasks from the back of its own queue and, once
+	 * that is empty, steals from the front of the others.
+	 */
+	class WorkStealingQueues {
+		public:
+			WorkStealingQueues(int count);
+			void push(int queue, const SearchTask& task);
+			bool take(int queue, SearchTask* task);
+			int size();
+		private:
+			struct Queue {
+				mutex lock;
+				deque<SearchTask> tasks;
+			};
+			vector<Queue> queues;
+	};
+
+	/**
+	 * The shared state of a parallel count: the task queues,
+	 * the solutions found so far, how many tasks are queued
+	 * or being counted (the count is over once none are),
+	 * and how many workers are waiting for a task.
+	 */
+	class ParallelSearch {
+		public:
+			ParallelSearch(int threadCount, int limit);
+			void push(int queue, SudokuBoard* board, int round);
+			bool isDone();
+			WorkStealingQueues queues;
+			atomic<int> solutionCount;
+			atomic<int> pending;
+			atomic<int> idle;
+			atomic<bool> exceeded;
+			int limit;
+			int nextQueue;
+	};
+
+	/**
+	 * How many levels of the guess tree may be split into
+	 * separate tasks when counting in parallel, and roughly
+	 * how many tasks to aim for per thread so that stealing
+	 * can even out uneven subtrees.
+	 */
+	const int PARALLEL_MAX_SPLIT_DEPTH = 8;
+	const int PARALLEL_TASKS_PER_THREAD = 4;
+
+	/**
+	 * Puzzles with at most this many givens are counted in
+	 * parallel by countSolutionsLimited().  Denser puzzles
+	 * are counted faster than the threads can be started.
+	 */
+	const int PARALLEL_MAX_GIVENS = 21;
+
+	/**
+	 * Possibility buckets hold two 64 bit words (enough for
+	 * 81 cells) for each possibility count from 0 to 9.
+	 */
+	const int POSSIBILITY_BUCKET_SIZE = (ROW_COL_SEC_SIZE+1)*2;
+
+	/**
+	 * Reading the clock costs more than a step, so the
+	 * deadline is only checked once in this many steps.
+	 */
+	const long LIMIT_CLOCK_INTERVAL = 64;
+
 	void shuffleArray(int* array, int size);
 	SudokuBoard::Symmetry getRandomSymmetry();
 	int getLogCount(vector<LogItem*>* v, LogItem::LogType type);
@@ -102,6 +205,7 @@ namespace qqwing {
 	static inline int getPossibilityIndex(int valueIndex, int cell);
 	static inline int rowColumnToCell(int row, int column);
 	static inline int sectionToCell(int section, int offset);
+	static inline int lowestSetBit(uint64_t bits);
 
 	/**
 	 * Create a new Sudoku board
@@ -111,17 +215,29 @@ namespace qqwing {
 		solution ( new int[BOARD_SIZE] ),
 		solutionRound ( new int[BOARD_SIZE] ),
 		possibilities ( new int[POSSIBILITY_SIZE] ),
+		possibilityCount ( new int[BOARD_SIZE] ),
+		possibilityBuckets ( new uint64_t[POSSIBILITY_BUCKET_SIZE] ),
 		randomBoardArray ( new int[BOARD_SIZE] ),
+		randomBoardOrder ( new int[BOARD_SIZE] ),
 		randomPossibilityArray ( new int[ROW_COL_SEC_SIZE] ),
 		recordHistory ( false ),
 		logHistory( false ),
+		batchSolve( false ),
 		solveHistory ( new vector<LogItem*>() ),
 		solveInstructions ( new vector<LogItem*>() ),
 		printStyle ( READABLE ),
-		lastSolveRound (0)
+		lastSolveRound (0),
+		maxSteps (0),
+		maxMicroseconds (0),
+		stepCount (0),
+		solveTime ( chrono::steady_clock::duration::zero() ),
+		limitExceeded (false),
+		solveStack ( new vector<SolveFrame>() ),
+		solveState ( NOT_SOLVED )
 	{
 		{for (int i=0; i<BOARD_SIZE; i++){
 			randomBoardArray[i] = i;
+			randomBoardOrder[i] = i;
 		}}
 		{for (int i=0; i<ROW_COL_SEC_SIZE; i++){
 			randomPossibilityArray[i] = i;
@@ -182,6 +298,10 @@ namespace qqwing {
 		{for (int i=0; i<POSSIBILITY_SIZE; i++){
 			possibilities[i] = 0;
 		}}
+		{for (int i=0; i<BOARD_SIZE; i++){
+			possibilityCount[i] = ROW_COL_SEC_SIZE;
+		}}
+		rebuildPossibilityBuckets();
 
 		{for (unsigned int i=0; i<solveHistory->size(); i++){
 			delete solveHistory->at(i);
@@ -306,6 +426,49 @@ namespace qqwing {
 	void SudokuBoard::shuffleRandomArrays(){
 		shuffleArray(randomBoardArray, BOARD_SIZE);
 		shuffleArray(randomPossibilityArray, ROW_COL_SEC_SIZE);
+		{for (int i=0; i<BOARD_SIZE; i++){
+			randomBoardOrder[randomBoardArray[i]] = i;
+		}}
+		rebuildPossibilityBuckets();
+	}
+
+	/**
+	 * Put every unsolved cell into the bucket for its
+	 * possibility count, at its place in the shuffled
+	 * board order.
+	 */
+	void SudokuBoard::rebuildPossibilityBuckets(){
+		{for (int i=0; i<POSSIBILITY_BUCKET_SIZE; i++){
+			possibilityBuckets[i] = 0;
+		}}
+		{for (int position=0; position<BOARD_SIZE; position++){
+			addToPossibilityBucket(position);
+		}}
+	}
+
+	void SudokuBoard::addToPossibilityBucket(int position){
+		if (solution[position] != 0) return;
+		int order = randomBoardOrder[position];
+		possibilityBuckets[possibilityCount[position]*2 + order/64] |= (uint64_t)1 << (order%64);
+	}
+
+	void SudokuBoard::removeFromPossibilityBucket(int position){
+		if (solution[position] != 0) return;
+		int order = randomBoardOrder[position];
+		possibilityBuckets[possibilityCount[position]*2 + order/64] &= ~((uint64_t)1 << (order%64));
+	}
+
+	/**
+	 * Eliminate a possibility that is still open, recording
+	 * the round in which it was eliminated and moving its
+	 * cell down one possibility bucket.
+	 */
+	void SudokuBoard::removePossibility(int valPos, int round){
+		int position = valPos/ROW_COL_SEC_SIZE;
+		removeFromPossibilityBucket(position);
+		possibilities[valPos] = round;
+		possibilityCount[position]--;
+		addToPossibilityBucket(position);
 	}
 
 	void SudokuBoard::clearPuzzle(){
@@ -330,6 +493,12 @@ namespace qqwing {
 		bool lHistory = logHistory;
 		setLogHistory(false);
 
+		// A puzzle is only unique if every count runs to the
+		// end, so generating ignores the solve limits.
+		uint64_t steps = maxSteps;
+		uint64_t microseconds = maxMicroseconds;
+		setSolveLimits(0, 0);
+
 		clearPuzzle();
 
 		// Start by getting the randomness in order so that
@@ -408,8 +577,7 @@ namespace qqwing {
 					savedSym3 = puzzle[positionsym3];
 					puzzle[positionsym3] = 0;
 				}
-				reset();
-				if (countSolutions(2, true) > 1){
+				if (countSolutionsLimited() > 1){
 					// Put it back in, it is needed
 					puzzle[position] = savedValue;
 					if (positionsym1 >= 0 && savedSym1 != 0) puzzle[positionsym1] = savedSym1;
@@ -425,6 +593,7 @@ namespace qqwing {
 		// Restore recording history.
 		setRecordHistory(recHistory);
 		setLogHistory(lHistory);
+		setSolveLimits(steps, microseconds);
 
 		return true;
 
@@ -450,10 +619,50 @@ namespace qqwing {
 		logHistory = logHist;
 	}
 
+	void SudokuBoard::setBatchSolve(bool batch){
+		batchSolve = batch;
+	}
+
+	void SudokuBoard::setSolveLimits(uint64_t steps, uint64_t microseconds){
+		maxSteps = steps;
+		maxMicroseconds = microseconds;
+	}
+
+	bool SudokuBoard::isLimitExceeded(){
+		return limitExceeded;
+	}
+
+	/**
+	 * Start the step count and clock for a new solve or count.
+	 */
+	void SudokuBoard::startLimits(){
+		stepCount = 0;
+		solveTime = chrono::steady_clock::duration::zero();
+		limitExceeded = false;
+		if (maxMicroseconds > 0) deadline = chrono::steady_clock::now() + chrono::microseconds(maxMicroseconds);
+	}
+
+	/**
+	 * Count a step, returning true once the limits have been
+	 * reached.  Searches unwind as soon as this happens.
+	 */
+	bool SudokuBoard::checkLimits(){
+		if (limitExceeded) return true;
+		stepCount++;
+		if (maxSteps > 0 && stepCount > maxSteps){
+			limitExceeded = true;
+		} else if (maxMicroseconds > 0 && stepCount % LIMIT_CLOCK_INTERVAL == 0 && chrono::steady_clock::now() >= deadline){
+			limitExceeded = true;
+		}
+		return limitExceeded;
+	}
+
 	void SudokuBoard::addHistoryItem(LogItem* l){
-		if (logHistory){
-			l->print();
-			cout << endl;
+		if (logHistory && isOutputEnabled()){
+			OutputBuffer& out = getOutputBuffer();
+			l->print(out);
+			out.put('\n');
+			out.flush();
 		}
 		if (recordHistory){
 			solveHistory->push_back(l);
@@ -464,35 +673,42 @@ namespace qqwing {
 	}
 
 	void SudokuBoard::printHistory(vector<LogItem*>* v){
+		if (!isOutputEnabled()) return;
+		OutputBuffer& out = getOutputBuffer();
 		if (!recordHistory){
-			cout << "History was not recorded.";
+			out.put("History was not recorded.");
 			if (printStyle == CSV){
-				cout << " -- ";
+				out.put(" -- ");
 			} else {
-				cout << endl;
+				out.put('\n');
 			}
 		}
 		{for (unsigned int i=0;i<v->size();i++){
-			cout << i+1 << ". ";
-			v->at(i)->print();
+			out.putNumber(i+1);
+			out.put(". ");
+			v->at(i)->print(out);
 			if (printStyle == CSV){
-				cout << " -- ";
+				out.put(" -- ");
 			} else {
-				cout << endl;
+				out.put('\n');
 			}
 		}}
 		if (printStyle == CSV){
-			cout << ",";
+			out.put(',');
 		} else {
-			cout << endl;
+			out.put('\n');
 		}
+		out.flush();
 	}
 
 	void SudokuBoard::printSolveInstructions(){
 		if (isSolved()){
 			printHistory(solveInstructions);
 		} else {
-			cout << "No solve instructions - Puzzle is not possible to solve." << endl;
+			if (!isOutputEnabled()) return;
+			OutputBuffer& out = getOutputBuffer();
+			out.put("No solve instructions - Puzzle is not possible to solve.\n");
+			out.flush();
 		}
 	}
 
@@ -501,30 +717,93 @@ namespace qqwing {
 	}
 
 	bool SudokuBoard::solve(){
+		beginSolve();
+		return continueSolve(0) == SOLVED;
+	}
+
+	void SudokuBoard::beginSolve(){
 		reset();
 		shuffleRandomArrays();
-		return solve(2);
+		startLimits();
+		solveStack->clear();
+		solveStack->push_back(SolveFrame(2));
+		solveState = SOLVING;
+		lastSolveRound = 2;
 	}
 
-	bool SudokuBoard::solve(int round){
-		lastSolveRound = round;
-
-		while (singleSolveMove(round)){
-			if (isSolved()) return true;
-			if (isImpossible()) return false;
+	/**
+	 * The search runs on an explicit stack of frames rather
+	 * than by recursion, so that it can stop after any step
+	 * and pick up again later.  Each frame makes logical
+	 * moves until there are none left, then tries guesses
+	 * one at a time, pushing a frame to follow each guess.
+	 * A frame that runs into a contradiction is popped and
+	 * its guess rolled back so the frame below can try the
+	 * next one.
+	 */
+	SudokuBoard::SolveState SudokuBoard::continueSolve(uint64_t stepBudget){
+		// The clock restarts with each slice, less the time already used
+		chrono::steady_clock::time_point sliceStart;
+		if (maxMicroseconds > 0){
+			sliceStart = chrono::steady_clock::now();
+			deadline = sliceStart + chrono::microseconds(maxMicroseconds) - solveTime;
 		}
 
-		int nextGuessRound = round+1;
-		int nextRound = round+2;
-		for (int guessNumber=0; guess(nextGuessRound, guessNumber); guessNumber++){
-			if (isImpossible() || !solve(nextRound)){
-				rollbackRound(nextRound);
-				rollbackRound(nextGuessRound);
+		for (uint64_t step=0; solveState == SOLVING && (stepBudget == 0 || step < stepBudget); step++){
+			if (checkLimits()){
+				while (solveState == SOLVING) endFrame(false);
+				break;
+			}
+
+			SolveFrame& frame = solveStack->back();
+			if (!frame.guessing){
+				if (singleSolveMove(frame.round)){
+					if (isSolved()) endFrame(true);
+					else if (isImpossible()) endFrame(false);
+				} else {
+					frame.guessing = true;
+				}
+			} else if (guess(frame.round+1, frame.guessNumber)){
+				frame.guessNumber++;
+				if (isImpossible()){
+					rollbackRound(frame.round+2);
+					rollbackRound(frame.round+1);
+				} else {
+					lastSolveRound = frame.round+2;
+					solveStack->push_back(SolveFrame(frame.round+2));
+				}
 			} else {
-				return true;
+				endFrame(false);
 			}
 		}
-		return false;
+
+		if (maxMicroseconds > 0) solveTime += chrono::steady_clock::now() - sliceStart;
+		return solveState;
+	}
+
+	/**
+	 * Finish the top frame of a resumable solve.  A solved
+	 * puzzle ends the whole search.  Otherwise the guess
+	 * that led to the frame is rolled back, or the search
+	 * ends unsolved if it was the first frame.
+	 */
+	SudokuBoard::SolveState SudokuBoard::endFrame(bool solved){
+		if (solved){
+			solveStack->clear();
+			solveState = SOLVED;
+			return solveState;
+		}
+
+		solveStack->pop_back();
+		if (solveStack->empty()){
+			solveState = NOT_SOLVED;
+			return solveState;
+		}
+
+		SolveFrame& frame = solveStack->back();
+		rollbackRound(frame.round+2);
+		rollbackRound(frame.round+1);
+		return solveState;
 	}
 
 	bool SudokuBoard::hasUniqueSolution(){
@@ -536,6 +815,11 @@ namespace qqwing {
 	}
 
 	int SudokuBoard::countSolutionsLimited(){
+		// Asking for the core count reads the system configuration, so do it once
+		static const unsigned int hardwareThreads = thread::hardware_concurrency();
+		if (hardwareThreads > 1 && getGivenCount() <= PARALLEL_MAX_GIVENS){
+			return countSolutionsParallel(2, 0);
+		}
 		return countSolutions(true);
 	}
 
@@ -547,12 +831,16 @@ namespace qqwing {
 		setLogHistory(false);
 
 		reset();
+		startLimits();
 		int solutionCount = countSolutions(2, limitToTwo);
 
 		// Restore recording history.
 		setRecordHistory(recHistory);
 		setLogHistory(lHistory);
 
+		// Branches skipped at the limits may hold more solutions
+		if (limitExceeded && !(limitToTwo && solutionCount >= 2)) return -1;
+		if (limitToTwo && solutionCount > 2) return 2;
 		return solutionCount;
 	}
 
@@ -562,7 +850,7 @@ namespace qqwing {
 				rollbackRound(round);
 				return 1;
 			}
-			if (isImpossible()){
+			if (isImpossible() || checkLimits()){
 				rollbackRound(round);
 				return 0;
 			}
@@ -570,7 +858,7 @@ namespace qqwing {
 
 		int solutions = 0;
 		int nextRound = round+1;
-		for (int guessNumber=0; guess(nextRound, guessNumber); guessNumber++){
+		for (int guessNumber=0; !checkLimits() && guess(nextRound, guessNumber); guessNumber++){
 			solutions += countSolutions(nextRound, limitToTwo);
 			if (limitToTwo && solutions >=2){
 				rollbackRound(round);
@@ -581,17 +869,153 @@ namespace qqwing {
 		return solutions;
 	}
 
+	int SudokuBoard::countSolutionsParallel(int limit, int threadCount){
+		// Don't record history while counting.
+		bool recHistory = recordHistory;
+		setRecordHistory(false);
+		bool lHistory = logHistory;
+		setLogHistory(false);
+
+		if (threadCount <= 0) threadCount = (int)thread::hardware_concurrency();
+		if (threadCount <= 0) threadCount = 1;
+
+		// Each guess level roughly doubles the number of tasks
+		int splitDepth = 1;
+		while ((1 << splitDepth) < threadCount*PARALLEL_TASKS_PER_THREAD && splitDepth < PARALLEL_MAX_SPLIT_DEPTH){
+			splitDepth++;
+		}
+
+		reset();
+		startLimits();
+		ParallelSearch search(threadCount, limit);
+		countSolutionsShared(2, splitDepth, &search, -1);
+		if (limitExceeded) search.exceeded = true;
+
+		vector<thread> workers;
+		{for (int t=0; t<threadCount; t++){
+			workers.push_back(thread([&search, t](){
+				SearchTask task;
+				while (search.pending > 0){
+					if (!search.queues.take(t, &task)){
+						this_thread::yield();
+						continue;
+					}
+					search.idle--;
+					if (!search.isDone()){
+						task.board->countSolutionsShared(task.round, 0, &search, t);
+						if (task.board->isLimitExceeded()) search.exceeded = true;
+					}
+					delete task.board;
+					search.idle++;
+					search.pending--;
+				}
+			}));
+		}}
+		{for (unsigned int t=0; t<workers.size(); t++){
+			workers[t].join();
+		}}
+
+		// Restore recording history.
+		setRecordHistory(recHistory);
+		setLogHistory(lHistory);
+
+		limitExceeded = search.exceeded;
+		int solutions = search.solutionCount;
+		if (limit > 0 && solutions > limit) solutions = limit;
+		if (limitExceeded && !(limit > 0 && solutions == limit)) return -1;
+		return solutions;
+	}
+
+	/**
+	 * Count solutions the same way as countSolutions(int, bool),
+	 * adding each one found to the search's shared counter.
+	 * Guesses made splitDepth levels below this round are not
+	 * followed; a copy of the board is queued as a task instead,
+	 * dealt out to the workers in turn.  With a splitDepth of
+	 * zero, a worker counting on queue only queues a guess when
+	 * another worker is idle.
+	 */
+	void SudokuBoard::countSolutionsShared(int round, int splitDepth, ParallelSearch* search, int queue){
+		while (singleSolveMove(round)){
+			if (isSolved()){
+				rollbackRound(round);
+				search->solutionCount++;
+				return;
+			}
+			if (isImpossible() || checkLimits()){
+				rollbackRound(round);
+				return;
+			}
+		}
+
+		int nextRound = round+1;
+		for (int guessNumber=0; !search->isDone() && !checkLimits() && guess(nextRound, guessNumber); guessNumber++){
+			if (splitDepth == 1 || (splitDepth == 0 && search->idle > 0)){
+				SudokuBoard* copy = new SudokuBoard();
+				copy->copyState(*this);
+				search->push(queue, copy, nextRound);
+				rollbackRound(nextRound);
+			} else {
+				countSolutionsShared(nextRound, splitDepth > 0 ? splitDepth-1 : 0, search, queue);
+			}
+		}
+		rollbackRound(round);
+	}
+
+	/**
+	 * Copy the puzzle and the current solve state (but not
+	 * the history) from another board.
+	 */
+	void SudokuBoard::copyState(const SudokuBoard& other){
+		{for (int i=0; i<BOARD_SIZE; i++){
+			puzzle[i] = other.puzzle[i];
+			solution[i] = other.solution[i];
+			solutionRound[i] = other.solutionRound[i];
+			randomBoardArray[i] = other.randomBoardArray[i];
+		}}
+		{for (int i=0; i<POSSIBILITY_SIZE; i++){
+			possibilities[i] = other.possibilities[i];
+		}}
+		{for (int i=0; i<ROW_COL_SEC_SIZE; i++){
+			randomPossibilityArray[i] = other.randomPossibilityArray[i];
+		}}
+		{for (int i=0; i<BOARD_SIZE; i++){
+			possibilityCount[i] = other.possibilityCount[i];
+			randomBoardOrder[i] = other.randomBoardOrder[i];
+		}}
+		{for (int i=0; i<POSSIBILITY_BUCKET_SIZE; i++){
+			possibilityBuckets[i] = other.possibilityBuckets[i];
+		}}
+		recordHistory = false;
+		logHistory = false;
+		batchSolve = other.batchSolve;
+		printStyle = other.printStyle;
+		lastSolveRound = other.lastSolveRound;
+
+		// Copies share the deadline but count their own steps
+		maxSteps = other.maxSteps;
+		maxMicroseconds = other.maxMicroseconds;
+		deadline = other.deadline;
+		stepCount = 0;
+		limitExceeded = false;
+	}
+
 	void SudokuBoard::rollbackRound(int round){
 		if (logHistory || recordHistory) addHistoryItem(new LogItem(round, LogItem::ROLLBACK));
 		{for (int i=0; i<BOARD_SIZE; i++){
 			if (solutionRound[i] == round){
 				solutionRound[i] = 0;
 				solution[i] = 0;
+				addToPossibilityBucket(i);
 			}
 		}}
 		{for (int i=0; i<POSSIBILITY_SIZE; i++){
 			if (possibilities[i] == round){
+				int position = i/ROW_COL_SEC_SIZE;
+				removeFromPossibilityBucket(position);
 				possibilities[i] = 0;
+				possibilityCount[position]++;
+				addToPossibilityBucket(position);
 			}
 		}}
 
@@ -609,40 +1033,27 @@ namespace qqwing {
 		return true;
 	}
 
+	/**
+	 * The puzzle is impossible if any unsolved cell
+	 * has run out of possibilities.
+	 */
 	bool SudokuBoard::isImpossible(){
-		for (int position=0; position<BOARD_SIZE; position++){
-			if (solution[position] == 0){
-				int count = 0;
-				for (int valIndex=0; valIndex<ROW_COL_SEC_SIZE; valIndex++){
-					int valPos = getPossibilityIndex(valIndex,position);
-					if (possibilities[valPos] == 0) count++;
-				}
-				if (count == 0) {
-					return true;
-				}
-			}
-		}
-		return false;
+		return possibilityBuckets[0] != 0 || possibilityBuckets[1] != 0;
 	}
 
+	/**
+	 * Find the unsolved cell with the fewest possibilities,
+	 * taking the first in the shuffled board order on ties.
+	 * This is the lowest bit of the first non-empty bucket.
+	 */
 	int SudokuBoard::findPositionWithFewestPossibilities(){
-		int minPossibilities = 10;
-		int bestPosition = 0;
-		{for (int i=0; i<BOARD_SIZE; i++){
-			int position = randomBoardArray[i];
-			if (solution[position] == 0){
-				int count = 0;
-				for (int valIndex=0; valIndex<ROW_COL_SEC_SIZE; valIndex++){
-					int valPos = getPossibilityIndex(valIndex,position);
-					if (possibilities[valPos] == 0) count++;
-				}
-				if (count < minPossibilities){
-					minPossibilities = count;
-					bestPosition = position;
-				}
-			}
+		{for (int count=0; count<=ROW_COL_SEC_SIZE; count++){
+			uint64_t low = possibilityBuckets[count*2];
+			uint64_t high = possibilityBuckets[count*2 + 1];
+			if (low != 0) return randomBoardArray[lowestSetBit(low)];
+			if (high != 0) return randomBoardArray[64 + lowestSetBit(high)];
 		}}
-		return bestPosition;
+		return 0;
 	}
 
 	bool SudokuBoard::guess(int round, int guessNumber){
@@ -665,10 +1076,15 @@ namespace qqwing {
 	}
 
 	bool SudokuBoard::singleSolveMove(int round){
-		if (onlyPossibilityForCell(round)) return true;
-		if (onlyValueInSection(round)) return true;
-		if (onlyValueInRow(round)) return true;
-		if (onlyValueInColumn(round)) return true;
+		if (batchSolve){
+			// A sweep that finds nothing has ruled out all singles
+			if (markAllSingles(round)) return true;
+		} else {
+			if (onlyPossibilityForCell(round)) return true;
+			if (onlyValueInSection(round)) return true;
+			if (onlyValueInRow(round)) return true;
+			if (onlyValueInColumn(round)) return true;
+		}
 		if (handleNakedPairs(round)) return true;
 		if (pointingRowReduction(round)) return true;
 		if (pointingColumnReduction(round)) return true;
@@ -680,6 +1096,62 @@ namespace qqwing {
 		return false;
 	}
 
+	/**
+	 * Mark every single and hidden single that can be found in
+	 * one sweep of the board.  Each cell is checked against the
+	 * possibilities as they stand when the sweep reaches it, so
+	 * moves made earlier in the same sweep are accounted for.
+	 */
+	bool SudokuBoard::markAllSingles(int round){
+		bool doneSomething = false;
+		for (int position=0; position<BOARD_SIZE; position++){
+			if (solution[position] == 0 && possibilityCount[position] == 1){
+				int value = 0;
+				for (int valIndex=0; valIndex<ROW_COL_SEC_SIZE; valIndex++){
+					if (possibilities[getPossibilityIndex(valIndex,position)] == 0) value = valIndex+1;
+				}
+				mark(position, round, value);
+				if (logHistory || recordHistory) addHistoryItem(new LogItem(round, LogItem::SINGLE, value, position));
+				doneSomething = true;
+			}
+		}
+		if (doneSomething) return true;
+
+		// Mark the last open cell for each value in a row, column or section
+		auto markHiddenSingles = [&](const int* unit, LogItem::LogType type){
+			for (int valIndex=0; valIndex<ROW_COL_SEC_SIZE; valIndex++){
+				int count = 0;
+				int lastPosition = 0;
+				for (int i=0; i<ROW_COL_SEC_SIZE; i++){
+					if (possibilities[getPossibilityIndex(valIndex,unit[i])] == 0){
+						count++;
+						lastPosition = unit[i];
+					}
+				}
+				if (count == 1){
+					int value = valIndex+1;
+					if (logHistory || recordHistory) addHistoryItem(new LogItem(round, type, value, lastPosition));
+					mark(lastPosition, round, value);
+					doneSomething = true;
+				}
+			}
+		};
+		int unit[ROW_COL_SEC_SIZE];
+		for (int section=0; section<ROW_COL_SEC_SIZE; section++){
+			for (int i=0; i<ROW_COL_SEC_SIZE; i++) unit[i] = sectionToCell(section,i);
+			markHiddenSingles(unit, LogItem::HIDDEN_SINGLE_SECTION);
+		}
+		for (int row=0; row<ROW_COL_SEC_SIZE; row++){
+			for (int i=0; i<ROW_COL_SEC_SIZE; i++) unit[i] = rowColumnToCell(row,i);
+			markHiddenSingles(unit, LogItem::HIDDEN_SINGLE_ROW);
+		}
+		for (int col=0; col<ROW_COL_SEC_SIZE; col++){
+			for (int i=0; i<ROW_COL_SEC_SIZE; i++) unit[i] = rowColumnToCell(i,col);
+			markHiddenSingles(unit, LogItem::HIDDEN_SINGLE_COLUMN);
+		}
+		return doneSomething;
+	}
+
 	bool SudokuBoard::colBoxReduction(int round){
 		for (int valIndex=0; valIndex<ROW_COL_SEC_SIZE; valIndex++){
 			for (int col=0; col<ROW_COL_SEC_SIZE; col++){
@@ -714,7 +1186,7 @@ namespace qqwing {
 							int position = rowColumnToCell(row2, col2);
 							int valPos = getPossibilityIndex(valIndex,position);
 							if (col != col2 && possibilities[valPos] == 0){
-								possibilities[valPos] = round;
+								removePossibility(valPos, round);
 								doneSomething = true;
 							}
 						}
@@ -763,7 +1235,7 @@ namespace qqwing {
 							int position = rowColumnToCell(row2, col2);
 							int valPos = getPossibilityIndex(valIndex,position);
 							if (row != row2 && possibilities[valPos] == 0){
-								possibilities[valPos] = round;
+								removePossibility(valPos, round);
 								doneSomething = true;
 							}
 						}
@@ -807,7 +1279,7 @@ namespace qqwing {
 						int section2 = cellToSection(position);
 						int valPos = getPossibilityIndex(valIndex,position);
 						if (section != section2 && possibilities[valPos] == 0){
-							possibilities[valPos] = round;
+							removePossibility(valPos, round);
 							doneSomething = true;
 						}
 					}}
@@ -850,7 +1322,7 @@ namespace qqwing {
 						int section2 = cellToSection(position);
 						int valPos = getPossibilityIndex(valIndex,position);
 						if (section != section2 && possibilities[valPos] == 0){
-							possibilities[valPos] = round;
+							removePossibility(valPos, round);
 							doneSomething = true;
 						}
 					}}
@@ -865,12 +1337,7 @@ namespace qqwing {
 	}
 
 	int SudokuBoard::countPossibilities(int position){
-		int count = 0;
-		for (int valIndex=0; valIndex<ROW_COL_SEC_SIZE; valIndex++){
-			int valPos = getPossibilityIndex(valIndex,position);
-			if (possibilities[valPos] == 0) count++;
-		}
-		return count;
+		return possibilityCount[position];
 	}
 
 	bool SudokuBoard::arePossibilitiesSame(int position1, int position2){
@@ -890,7 +1357,7 @@ namespace qqwing {
 			int valPos1 = getPossibilityIndex(valIndex,position1);
 			int valPos2 = getPossibilityIndex(valIndex,position2);
 			if (possibilities[valPos1] == 0 && possibilities[valPos2] == 0){
-				possibilities[valPos2] = round;
+				removePossibility(valPos2, round);
 				doneSomething = true;
 			}
 		}
@@ -941,11 +1408,11 @@ namespace qqwing {
 									int valPos1 = getPossibilityIndex(valIndex3,position1);
 									int valPos2 = getPossibilityIndex(valIndex3,position2);
 									if (possibilities[valPos1] == 0){
-										possibilities[valPos1] = round;
+										removePossibility(valPos1, round);
 										doneSomething = true;
 									}
 									if (possibilities[valPos2] == 0){
-										possibilities[valPos2] = round;
+										removePossibility(valPos2, round);
 										doneSomething = true;
 									}
 								}
@@ -1006,11 +1473,11 @@ namespace qqwing {
 									int valPos1 = getPossibilityIndex(valIndex3,position1);
 									int valPos2 = getPossibilityIndex(valIndex3,position2);
 									if (possibilities[valPos1] == 0){
-										possibilities[valPos1] = round;
+										removePossibility(valPos1, round);
 										doneSomething = true;
 									}
 									if (possibilities[valPos2] == 0){
-										possibilities[valPos2] = round;
+										removePossibility(valPos2, round);
 										doneSomething = true;
 									}
 								}
@@ -1071,11 +1538,11 @@ namespace qqwing {
 									int valPos1 = getPossibilityIndex(valIndex3,position1);
 									int valPos2 = getPossibilityIndex(valIndex3,position2);
 									if (possibilities[valPos1] == 0){
-										possibilities[valPos1] = round;
+										removePossibility(valPos1, round);
 										doneSomething = true;
 									}
 									if (possibilities[valPos2] == 0){
-										possibilities[valPos2] = round;
+										removePossibility(valPos2, round);
 										doneSomething = true;
 									}
 								}
@@ -1253,7 +1720,7 @@ namespace qqwing {
 	 */
 	bool SudokuBoard::onlyPossibilityForCell(int round){
 		for (int position=0; position<BOARD_SIZE; position++){
-			if (solution[position] == 0){
+			if (solution[position] == 0 && possibilityCount[position] == 1){
 				int count = 0;
 				int lastValue = 0;
 				for (int valIndex=0; valIndex<ROW_COL_SEC_SIZE; valIndex++){
@@ -1286,6 +1753,7 @@ namespace qqwing {
 		if (solution[position] != 0) throw ("Marking position that already has been marked.");
 		if (solutionRound[position] !=0) throw ("Marking position that was marked another round.");
 		int valIndex = value-1;
+		removeFromPossibilityBucket(position);
 		solution[position] = value;
 
 		int possInd = getPossibilityIndex(valIndex,position);
@@ -1299,7 +1767,7 @@ namespace qqwing {
 			int valPos = getPossibilityIndex(valIndex,rowVal);
 			//cout << "Row Start: " << rowStart << " Row Value: " << rowVal << " Value Position: " << valPos << endl;
 			if (possibilities[valPos] == 0){
-				possibilities[valPos] = round;
+				removePossibility(valPos, round);
 			}
 		}
 
@@ -1310,7 +1778,7 @@ namespace qqwing {
 			int valPos = getPossibilityIndex(valIndex,colVal);
 			//cout << "Col Start: " << colStart << " Col Value: " << colVal << " Value Position: " << valPos << endl;
 			if (possibilities[valPos] == 0){
-				possibilities[valPos] = round;
+				removePossibility(valPos, round);
 			}
 		}}
 
@@ -1322,7 +1790,7 @@ namespace qqwing {
 				int valPos = getPossibilityIndex(valIndex,secVal);
 				//cout << "Sec Start: " << secStart << " Sec Value: " << secVal << " Value Position: " << valPos << endl;
 				if (possibilities[valPos] == 0){
-					possibilities[valPos] = round;
+					removePossibility(valPos, round);
 				}
 			}
 		}}
@@ -1331,7 +1799,7 @@ namespace qqwing {
 		{for (int valIndex=0; valIndex<ROW_COL_SEC_SIZE; valIndex++){
 			int valPos = getPossibilityIndex(valIndex,position);
 			if (possibilities[valPos] == 0){
-				possibilities[valPos] = round;
+				removePossibility(valPos, round);
 			}
 		}}
 	}
@@ -1342,39 +1810,42 @@ namespace qqwing {
 	 * member variables.
 	 */
 	void SudokuBoard::print(int* sudoku){
+		if (!isOutputEnabled()) return;
+		OutputBuffer& out = getOutputBuffer();
 		for(int i=0; i<BOARD_SIZE; i++){
 			if (printStyle == READABLE){
-				cout << " ";
+				out.put(' ');
 			}
 			if (sudoku[i]==0){
-				cout << '.';
+				out.put('.');
 			} else {
-				cout << sudoku[i];
+				out.put((char)('0'+sudoku[i]));
 			}
 			if (i == BOARD_SIZE-1){
 				if (printStyle == CSV){
-					cout << ",";
+					out.put(',');
 				} else {
-					cout << endl;
+					out.put('\n');
 				}
 				if (printStyle == READABLE || printStyle == COMPACT){
-					cout << endl;
+					out.put('\n');
 				}
 			} else if (i%ROW_COL_SEC_SIZE==ROW_COL_SEC_SIZE-1){
 				if (printStyle == READABLE || printStyle == COMPACT){
-					cout << endl;
+					out.put('\n');
 				}
 				if (i%SEC_GROUP_SIZE==SEC_GROUP_SIZE-1){
 					if (printStyle == READABLE){
-						cout << "-------|-------|-------" << endl;
+						out.put("-------|-------|-------\n");
 					}
 				}
 			} else if (i%GRID_SIZE==GRID_SIZE-1){
 				if (printStyle == READABLE){
-					cout << " |";
+					out.put(" |");
 				}
 			}
 		}
+		out.flush();
 	}
 
 	/**
@@ -1396,11 +1867,15 @@ namespace qqwing {
 		delete[] puzzle;
 		delete[] solution;
 		delete[] possibilities;
+		delete[] possibilityCount;
+		delete[] possibilityBuckets;
 		delete[] solutionRound;
 		delete[] randomBoardArray;
+		delete[] randomBoardOrder;
 		delete[] randomPossibilityArray;
 		delete solveHistory;
 		delete solveInstructions;
+		delete solveStack;
 	}
 
 	LogItem::LogItem(int r, LogType t){
@@ -1436,79 +1911,173 @@ namespace qqwing {
 	 * Print the current log item.  The message used is
 	 * determined by the type of log item.
 	 */
-	void LogItem::print(){
-		cout << "Round: " << getRound() << " - ";
+	void LogItem::print(OutputBuffer& out){
+		out.put("Round: ");
+		out.putNumber(getRound());
+		out.put(" - ");
 		switch(type){
 			case GIVEN:{
-				cout << "Mark given";
+				out.put("Mark given");
 			} break;
 			case ROLLBACK:{
-				cout << "Roll back round";
+				out.put("Roll back round");
 			} break;
 			case GUESS:{
-				cout << "Mark guess (start round)";
+				out.put("Mark guess (start round)");
 			} break;
 			case HIDDEN_SINGLE_ROW:{
-				cout << "Mark single possibility for value in row";
+				out.put("Mark single possibility for value in row");
 			} break;
 			case HIDDEN_SINGLE_COLUMN:{
-				cout << "Mark single possibility for value in column";
+				out.put("Mark single possibility for value in column");
 			} break;
 			case HIDDEN_SINGLE_SECTION:{
-				cout << "Mark single possibility for value in section";
+				out.put("Mark single possibility for value in section");
 			} break;
 			case SINGLE:{
-				cout << "Mark only possibility for cell";
+				out.put("Mark only possibility for cell");
 			} break;
 			case NAKED_PAIR_ROW:{
-				cout << "Remove possibilities for naked pair in row";
+				out.put("Remove possibilities for naked pair in row");
 			} break;
 			case NAKED_PAIR_COLUMN:{
-				cout << "Remove possibilities for naked pair in column";
+				out.put("Remove possibilities for naked pair in column");
 			} break;
 			case NAKED_PAIR_SECTION:{
-				cout << "Remove possibilities for naked pair in section";
+				out.put("Remove possibilities for naked pair in section");
 			} break;
 			case POINTING_PAIR_TRIPLE_ROW: {
-				cout << "Remove possibilities for row because all values are in one section";
+				out.put("Remove possibilities for row because all values are in one section");
 			} break;
 			case POINTING_PAIR_TRIPLE_COLUMN: {
-				cout << "Remove possibilities for column because all values are in one section";
+				out.put("Remove possibilities for column because all values are in one section");
 			} break;
 			case ROW_BOX: {
-				cout << "Remove possibilities for section because all values are in one row";
+				out.put("Remove possibilities for section because all values are in one row");
 			} break;
 			case COLUMN_BOX: {
-				cout << "Remove possibilities for section because all values are in one column";
+				out.put("Remove possibilities for section because all values are in one column");
 			} break;
 			case HIDDEN_PAIR_ROW: {
-				cout << "Remove possibilities from hidden pair in row";
+				out.put("Remove possibilities from hidden pair in row");
 			} break;
 			case HIDDEN_PAIR_COLUMN: {
-				cout << "Remove possibilities from hidden pair in column";
+				out.put("Remove possibilities from hidden pair in column");
 			} break;
 			case HIDDEN_PAIR_SECTION: {
-				cout << "Remove possibilities from hidden pair in section";
+				out.put("Remove possibilities from hidden pair in section");
 			} break;
 			default:{
-				cout << "!!! Performed unknown optimization !!!";
+				out.put("!!! Performed unknown optimization !!!");
 			} break;
 		}
 		if (value > 0 || position > -1){
-			cout << " (";
+			out.put(" (");
 			bool printed = false;
 			if (position > -1){
-				if (printed) cout << " - ";
-				cout << "Row: " << cellToRow(position)+1 << " - Column: " << cellToColumn(position)+1;
+				if (printed) out.put(" - ");
+				out.put("Row: ");
+				out.putNumber(cellToRow(position)+1);
+				out.put(" - Column: ");
+				out.putNumber(cellToColumn(position)+1);
 				printed = true;
 			}
 			if (value > 0){
-				if (printed) cout << " - ";
-				cout << "Value: " << value;
+				if (printed) out.put(" - ");
+				out.put("Value: ");
+				out.putNumber(value);
 				printed = true;
 			}
-			cout << ")";
+			out.put(")");
+		}
+	}
+
+	SolveFrame::SolveFrame(int r) :
+		round ( r ),
+		guessNumber ( 0 ),
+		guessing ( false )
+	{
+	}
+
+	SearchTask::SearchTask() :
+		board ( NULL ),
+		round ( 0 )
+	{
+	}
+
+	SearchTask::SearchTask(SudokuBoard* b, int r) :
+		board ( b ),
+		round ( r )
+	{
+	}
+
+	ParallelSearch::ParallelSearch(int threadCount, int l) :
+		queues ( threadCount ),
+		solutionCount ( 0 ),
+		pending ( 0 ),
+		idle ( threadCount ),
+		exceeded ( false ),
+		limit ( l ),
+		nextQueue ( 0 )
+	{
+	}
+
+	/**
+	 * Queue a task on the given worker's queue, or when queue
+	 * is negative, on each worker's queue in turn.
+	 */
+	void ParallelSearch::push(int queue, SudokuBoard* board, int round){
+		if (queue < 0) queue = nextQueue++ % queues.size();
+		pending++;
+		queues.push(queue, SearchTask(board, round));
+	}
+
+	/**
+	 * Whether counting can stop early, because the limit on
+	 * solutions or the solve limits have been reached.
+	 */
+	bool ParallelSearch::isDone(){
+		return (limit > 0 && solutionCount >= limit) || exceeded;
+	}
+
+	WorkStealingQueues::WorkStealingQueues(int count) :
+		queues ( count )
+	{
+	}
+
+	int WorkStealingQueues::size(){
+		return (int)queues.size();
+	}
+
+	void WorkStealingQueues::push(int queue, const SearchTask& task){
+		lock_guard<mutex> guard(queues[queue].lock);
+		queues[queue].tasks.push_back(task);
+	}
+
+	/**
+	 * Take the next task for the given worker, stealing from
+	 * another worker's queue when its own is empty.  Returns
+	 * false once every queue is empty.
+	 */
+	bool WorkStealingQueues::take(int queue, SearchTask* task){
+		{
+			lock_guard<mutex> guard(queues[queue].lock);
+			if (!queues[queue].tasks.empty()){
+				*task = queues[queue].tasks.back();
+				queues[queue].tasks.pop_back();
+				return true;
+			}
 		}
+		{for (unsigned int i=1; i<queues.size(); i++){
+			Queue& victim = queues[(queue+i)%queues.size()];
+			lock_guard<mutex> guard(victim.lock);
+			if (!victim.tasks.empty()){
+				*task = victim.tasks.front();
+				victim.tasks.pop_front();
+				return true;
+			}
+		}}
+		return false;
 	}
 
 	/**
@@ -1631,4 +2200,19 @@ namespace qqwing {
 				+ ((offset/GRID_SIZE)*ROW_COL_SEC_SIZE)
 				+ (offset%GRID_SIZE);
 	}
+
+	/**
+	 * Given a non-zero 64 bit value, calculate the
+	 * index (0-63) of its lowest set bit.
+	 */
+	static inline int lowestSetBit(uint64_t bits){
+		#if defined(_MSC_VER)
+			unsigned long index;
+			if (_BitScanForward(&index, (unsigned long)bits)) return (int)index;
+			_BitScanForward(&index, (unsigned long)(bits >> 32));
+			return (int)index + 32;
+		#else
+			return __builtin_ctzll(bits);
+		#endif
+	}
 }
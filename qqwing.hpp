@@ -22,6 +22,8 @@
 #ifndef QQWING_HPP
 	#define QQWING_HPP
 
+	#include <chrono>
+	#include <stdint.h>
 	#include <string>
 	#include <vector>
 
@@ -30,6 +32,8 @@
 		using namespace std;
 
 		class LogItem;
+		class ParallelSearch;
+		class SolveFrame;
 
 		const int GRID_SIZE = 3;
 		const int ROW_COL_SEC_SIZE = GRID_SIZE*GRID_SIZE;
@@ -61,6 +65,11 @@
 					INTERMEDIATE,
 					EXPERT
 				};
+				enum SolveState {
+					SOLVING,
+					SOLVED,
+					NOT_SOLVED
+				};
 				enum Symmetry {
 					NONE,
 					ROTATE90,
@@ -78,7 +87,34 @@
 				bool solve();
 
 				/**
-				 * Count the number of solutions to the puzzle
+				 * Start solving the puzzle without doing any
+				 * work yet.  The search is then run a slice at
+				 * a time by continueSolve(), keeping its state
+				 * on the board between slices, so a scheduler
+				 * can interleave many boards on a few threads.
+				 * A slice may run on a different thread than
+				 * the last, but only one thread at a time.
+				 */
+				void beginSolve();
+
+				/**
+				 * Carry on the solve started by beginSolve()
+				 * for up to stepBudget propagation steps and
+				 * guesses, or until it is done if stepBudget
+				 * is zero.  Returns SOLVING if there is more
+				 * to do, otherwise SOLVED or NOT_SOLVED,
+				 * exactly as solve() would have.  The solve
+				 * limits apply over all the slices together,
+				 * counting only the time spent in them.  A
+				 * solve stopped by the limits rolls back its
+				 * guesses, as one that runs out of them does.
+				 */
+				SudokuBoard::SolveState continueSolve(uint64_t stepBudget);
+
+				/**
+				 * Count the number of solutions to the puzzle.
+				 * Returns -1 if the solve limits were reached
+				 * before the count was known.
 				 */
 				int countSolutions();
 
@@ -90,12 +126,36 @@
 				 * are many possible solutions and can be used
 				 * when you are interested in knowing if the
 				 * puzzle has zero, one, or multiple solutions.
+				 * Sparse puzzles are counted in parallel on
+				 * every hardware core.  Returns -1 if the solve
+				 * limits were reached before two solutions or
+				 * the last one turned up.
 				 */
 				int countSolutionsLimited();
 
+				/**
+				 * Count the number of solutions to the puzzle
+				 * using several threads.  The top levels of
+				 * the guess tree are split into tasks, each
+				 * with its own copy of the board, which are
+				 * shared out across a work stealing pool.
+				 * While any worker is idle, busy workers hand
+				 * their next guesses to the pool as new tasks
+				 * rather than following them themselves.
+				 * When limit is greater than zero, counting
+				 * stops as soon as that many solutions have
+				 * been found and limit is returned.  A
+				 * threadCount of zero uses one thread per
+				 * hardware core.  Returns -1 if the solve
+				 * limits were reached first.
+				 */
+				int countSolutionsParallel(int limit, int threadCount);
+
 				/**
 				 * return true if the puzzle has a solution
-				 * and only a single solution
+				 * and only a single solution.  False if the
+				 * solve limits were reached before that was
+				 * known; isLimitExceeded() tells the two apart.
 				 */
 				bool hasUniqueSolution();
 				bool isSolved();
@@ -103,6 +163,33 @@
 				void setRecordHistory(bool recHistory);
 				void setLogHistory(bool logHist);
 				void setPrintStyle(PrintStyle ps);
+
+				/**
+				 * When batch solving is on, each solve step marks
+				 * every single and hidden single that one sweep of
+				 * the board turns up, rather than only the first.
+				 * Puzzles take far fewer passes to solve, but moves
+				 * may be attributed to different techniques in the
+				 * history, which can change the difficulty rating.
+				 */
+				void setBatchSolve(bool batch);
+
+				/**
+				 * Cut solving and counting short once maxSteps
+				 * propagation steps and guesses have been made,
+				 * or maxMicroseconds have passed since it began,
+				 * whichever comes first.  Zero means no limit.
+				 * When counting in parallel, the step limit
+				 * applies to each task separately.
+				 */
+				void setSolveLimits(uint64_t maxSteps, uint64_t maxMicroseconds);
+
+				/**
+				 * Whether the last solve or count was cut short
+				 * by the limits, in which case it gave up rather
+				 * than finding every solution.
+				 */
+				bool isLimitExceeded();
 				bool generatePuzzle();
 				bool generatePuzzleSymmetry(SudokuBoard::Symmetry symmetry);
 				int getGivenCount();
@@ -155,6 +242,23 @@
 				 */
 				int* possibilities;
 
+				/**
+				 * The number of possibilities still open for
+				 * each of the 81 squares, kept up to date as
+				 * possibilities are eliminated and rolled back.
+				 */
+				int* possibilityCount;
+
+				/**
+				 * For each possibility count (0-9), a bitset of
+				 * the unsolved squares with exactly that many
+				 * possibilities left.  Squares are indexed by
+				 * their place in randomBoardArray, so the lowest
+				 * set bit is the first such square in shuffled
+				 * order.
+				 */
+				uint64_t* possibilityBuckets;
+
 				/**
 				 * An array the size of the board (81) containing each
 				 * of the numbers 0-n exactly once.  This array may
@@ -163,6 +267,12 @@
 				 */
 				int* randomBoardArray;
 
+				/**
+				 * The inverse of randomBoardArray: the place (0-80)
+				 * of each position in the shuffled order.
+				 */
+				int* randomBoardOrder;
+
 				/**
 				 * An array with one element for each position (9), in
 				 * some random order to be used when trying each
@@ -180,6 +290,11 @@
 				 */
 				bool logHistory;
 
+				/**
+				 * Whether or not to mark all singles found in a sweep
+				 */
+				bool batchSolve;
+
 				/**
 				 * A list of moves used to solve the puzzle.
 				 * This list contains all moves, even on solve
@@ -204,15 +319,42 @@
 				 * The last round of solving
 				 */
 				int lastSolveRound;
+
+				/**
+				 * Limits on the current solve or count, the
+				 * steps taken so far and when time runs out.
+				 * A resumable solve also keeps the time it has
+				 * spent running, so that time parked between
+				 * slices does not count.
+				 */
+				uint64_t maxSteps;
+				uint64_t maxMicroseconds;
+				uint64_t stepCount;
+				chrono::steady_clock::time_point deadline;
+				chrono::steady_clock::duration solveTime;
+				bool limitExceeded;
+				void startLimits();
+				bool checkLimits();
+
+				/**
+				 * The guesses of a solve in progress, one frame
+				 * for each level of the search, and its result
+				 * once the stack has emptied.
+				 */
+				vector<SolveFrame>* solveStack;
+				SolveState solveState;
+				SudokuBoard::SolveState endFrame(bool solved);
 				bool reset();
 				bool singleSolveMove(int round);
+				bool markAllSingles(int round);
 				bool onlyPossibilityForCell(int round);
 				bool onlyValueInRow(int round);
 				bool onlyValueInColumn(int round);
 				bool onlyValueInSection(int round);
-				bool solve(int round);
 				int countSolutions(bool limitToTwo);
 				int countSolutions(int round, bool limitToTwo);
+				void countSolutionsShared(int round, int splitDepth, ParallelSearch* search, int queue);
+				void copyState(const SudokuBoard& other);
 				bool guess(int round, int guessNumber);
 				bool isImpossible();
 				void rollbackRound(int round);
@@ -224,6 +366,10 @@
 				bool hiddenPairInColumn(int round);
 				bool hiddenPairInSection(int round);
 				void mark(int position, int round, int value);
+				void removePossibility(int valPos, int round);
+				void addToPossibilityBucket(int position);
+				void removeFromPossibilityBucket(int position);
+				void rebuildPossibilityBuckets();
 				int findPositionWithFewestPossibilities();
 				bool handleNakedPairs(int round);
 				int countPossibilities(int position);
@@ -0,0 +1,719 @@
+#include "server.hpp"
+
+#include <iostream>
+
+#ifdef __linux__
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <errno.h>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <netinet/in.h>
+#include <signal.h>
+#include <string.h>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "corpus.hpp"
+#include "sudoku.h"
+
+// Longest request line accepted, anything longer closes the connection
+static const size_t SERVER_MAX_LINE = 1024;
+
+// Bytes read from a socket at a time
+static const size_t SERVER_READ_SIZE = 1 << 16;
+
+// Requests a connection may have waiting on the solvers before it is no longer read from
+static const uint64_t SERVER_MAX_IN_FLIGHT = 4096;
+
+// Events waited for at a time
+static const int SERVER_MAX_EVENTS = 64;
+
+// epoll identifiers of the listening socket and the wake up, signal and batch
+// timer descriptors, connections are numbered after them
+static const uint64_t LISTEN_ID = 0;
+static const uint64_t WAKE_ID = 1;
+static const uint64_t SIGNAL_ID = 2;
+static const uint64_t TIMER_ID = 3;
+static const uint64_t FIRST_CONNECTION_ID = 4;
+
+// Latencies are counted in power of two buckets of microseconds
+static const uint16_t LATENCY_BUCKETS = 40;
+
+// Marks a job whose line could not be read as a puzzle
+static const uint8_t INVALID_CELL = 0xFF;
+
+// Guesses and propagation steps a search runs before the solver thread moves on to the next
+static const uint64_t SERVER_SEARCH_SLICE = 1024;
+
+// One request on its way through the solvers
+struct ServerJob
+{
+	uint64_t connection;
+	uint64_t sequence;
+	std::chrono::steady_clock::time_point received;
+	sudoku_status status;
+	uint8_t puzzle[SUDOKU_CELLS];
+	uint8_t solution[SUDOKU_CELLS];
+};
+
+struct ServerConnection
+{
+	int socket;
+	std::string input;
+	std::string output;
+
+	// Sequence numbers of the next request read and the next answer written
+	uint64_t nextRequest;
+	uint64_t nextAnswer;
+
+	// Answers that came back before earlier ones
+	std::map<uint64_t, ServerJob> finished;
+
+	// epoll events currently asked for
+	uint32_t events;
+	bool readClosed;
+};
+
+// A job whose puzzle needs guessing, searched a slice at a time
+struct ServerSearch
+{
+	ServerJob job;
+	sudoku_search* search;
+};
+
+// Jobs passed between the event loop and the solver threads
+struct ServerQueues
+{
+	std::mutex lock;
+	std::condition_variable ready;
+	std::deque<std::vector<ServerJob>> pending;
+	std::vector<ServerJob> done;
+	bool stopping;
+
+	// Written to whenever jobs are done, to wake the event loop
+	int wake;
+};
+
+// How long requests took from being read to being answered
+struct LatencyStats
+{
+	uint64_t count;
+	uint64_t totalUs;
+	uint64_t maxUs;
+	uint64_t buckets[LATENCY_BUCKETS];
+};
+
+static void addLatency(LatencyStats& stats, uint64_t us)
+{
+	uint16_t bucket = 0;
+	while (bucket + 1 < LATENCY_BUCKETS && (1ULL << bucket) <= us)
+	{
+		++bucket;
+	}
+
+	++stats.buckets[bucket];
+	++stats.count;
+	stats.totalUs += us;
+	stats.maxUs = (us > stats.maxUs) ? us : stats.maxUs;
+}
+
+// The bound of the bucket holding the given fraction of latencies, in microseconds
+static uint64_t getLatencyPercentile(const LatencyStats& stats, double fraction)
+{
+	uint64_t wanted = (uint64_t)(stats.count * fraction);
+	uint64_t seen = 0;
+	for (uint16_t bucket = 0; bucket < LATENCY_BUCKETS; ++bucket)
+	{
+		seen += stats.buckets[bucket];
+		if (seen > wanted)
+		{
+			return 1ULL << bucket;
+		}
+	}
+
+	return stats.maxUs;
+}
+
+static const char* getStatusName(sudoku_status status)
+{
+	switch (status)
+	{
+	case SUDOKU_NO_SOLUTION:
+		return "no solution";
+	case SUDOKU_BUDGET_EXCEEDED:
+		return "budget exceeded";
+	default:
+		return "invalid";
+	}
+}
+
+// Solve batches of jobs until the server stops. Puzzles that need guessing take turns
+// a slice at a time with each other and with new batches, so a long search holds up
+// neither the jobs behind it nor the answers already found.
+static void runSolver(ServerQueues& queues)
+{
+	std::vector<ServerJob> batch;
+	std::vector<ServerSearch> searches;
+	std::vector<ServerJob> finished;
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> guard(queues.lock);
+			if (searches.empty())
+			{
+				queues.ready.wait(guard, [&]() { return queues.stopping || !queues.pending.empty(); });
+			}
+
+			if (queues.stopping)
+			{
+				break;
+			}
+
+			if (!queues.pending.empty())
+			{
+				batch.swap(queues.pending.front());
+				queues.pending.pop_front();
+			}
+		}
+
+		// Each puzzle is read and its solution written in place in its job. Jobs that
+		// could not be read as puzzles start with a byte no record allows, so they come
+		// back invalid.
+		for (size_t j = 0; j < batch.size(); ++j)
+		{
+			ServerSearch started;
+			started.job = batch[j];
+			started.job.status = sudoku_search_begin(started.job.puzzle, started.job.solution,
+				SUDOKU_RECORD_DIGITS, &started.search);
+
+			if (started.job.status == SUDOKU_IN_PROGRESS)
+			{
+				searches.push_back(started);
+			}
+			else
+			{
+				finished.push_back(started.job);
+			}
+		}
+		batch.clear();
+
+		for (size_t s = 0; s < searches.size();)
+		{
+			ServerSearch& running = searches[s];
+			running.job.status = sudoku_search_continue(running.search, SERVER_SEARCH_SLICE, running.job.solution);
+			if (running.job.status == SUDOKU_IN_PROGRESS)
+			{
+				++s;
+				continue;
+			}
+
+			finished.push_back(running.job);
+			running = searches.back();
+			searches.pop_back();
+		}
+
+		if (finished.empty())
+		{
+			continue;
+		}
+
+		bool wasEmpty;
+		{
+			std::lock_guard<std::mutex> guard(queues.lock);
+			wasEmpty = queues.done.empty();
+			queues.done.insert(queues.done.end(), finished.begin(), finished.end());
+		}
+		finished.clear();
+
+		// The event loop takes every finished job at once, so one wake up covers them all
+		if (wasEmpty)
+		{
+			uint64_t one = 1;
+			ssize_t written = write(queues.wake, &one, sizeof(one));
+			(void)written;
+		}
+	}
+
+	for (size_t s = 0; s < searches.size(); ++s)
+	{
+		sudoku_search_cancel(searches[s].search);
+	}
+}
+
+// Hand jobs to the solvers in batches of at most batchSize, returning the number of batches
+static uint64_t dispatchJobs(ServerQueues& queues, std::vector<ServerJob>& jobs, size_t begin, size_t end, uint32_t batchSize)
+{
+	uint64_t numBatches = 0;
+	{
+		std::lock_guard<std::mutex> guard(queues.lock);
+		for (size_t first = begin; first < end; first += batchSize)
+		{
+			size_t last = (end - first > batchSize) ? first + batchSize : end;
+			queues.pending.emplace_back(jobs.begin() + first, jobs.begin() + last);
+			++numBatches;
+		}
+	}
+
+	if (numBatches == 1)
+	{
+		queues.ready.notify_one();
+	}
+	else if (numBatches > 1)
+	{
+		queues.ready.notify_all();
+	}
+
+	jobs.erase(jobs.begin() + begin, jobs.begin() + end);
+	return numBatches;
+}
+
+// Ask epoll for the events a connection needs now: input while it has room for more
+// requests, and output while it has answers waiting
+static void updateEvents(int poll, uint64_t id, ServerConnection& connection)
+{
+	uint32_t events = 0;
+	if (!connection.readClosed && connection.nextRequest - connection.nextAnswer < SERVER_MAX_IN_FLIGHT)
+	{
+		events |= EPOLLIN;
+	}
+
+	if (!connection.output.empty())
+	{
+		events |= EPOLLOUT;
+	}
+
+	if (events != connection.events)
+	{
+		epoll_event event;
+		event.events = events;
+		event.data.u64 = id;
+		epoll_ctl(poll, EPOLL_CTL_MOD, connection.socket, &event);
+		connection.events = events;
+	}
+}
+
+// Write as much waiting output as the socket takes, returning false if the connection failed
+static bool writeOutput(ServerConnection& connection)
+{
+	size_t sent = 0;
+	while (sent < connection.output.size())
+	{
+		ssize_t n = send(connection.socket, connection.output.data() + sent, connection.output.size() - sent, MSG_NOSIGNAL);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				break;
+			}
+
+			return false;
+		}
+
+		sent += n;
+	}
+
+	connection.output.erase(0, sent);
+	return true;
+}
+
+// Read what the socket has, queueing a job for each complete request line.
+// Returns false if the connection failed or broke the protocol.
+static bool readInput(ServerConnection& connection, uint64_t id, std::vector<ServerJob>& jobs, std::vector<char>& buffer)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	for (;;)
+	{
+		ssize_t n = recv(connection.socket, buffer.data(), buffer.size(), 0);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				break;
+			}
+
+			return false;
+		}
+
+		if (n == 0)
+		{
+			connection.readClosed = true;
+			break;
+		}
+
+		connection.input.append(buffer.data(), n);
+		if ((size_t)n < buffer.size())
+		{
+			break;
+		}
+	}
+
+	size_t begin = 0;
+	size_t newline;
+	while ((newline = connection.input.find('\n', begin)) != std::string::npos)
+	{
+		const char* line = connection.input.data() + begin;
+		size_t length = newline - begin;
+		begin = newline + 1;
+
+		if (length > 0 && line[length - 1] == '\r')
+		{
+			--length;
+		}
+
+		if (length == 0)
+		{
+			continue;
+		}
+
+		ServerJob job;
+		job.connection = id;
+		job.sequence = connection.nextRequest++;
+		job.received = now;
+		if (length != SUDOKU_CELLS || !parseDigits(line, job.puzzle))
+		{
+			job.puzzle[0] = INVALID_CELL;
+		}
+		jobs.push_back(job);
+	}
+
+	connection.input.erase(0, begin);
+	return connection.input.size() <= SERVER_MAX_LINE;
+}
+
+// Add an answer to a connection's output once every earlier answer is there
+static void addAnswer(ServerConnection& connection, const ServerJob& job, LatencyStats& latency)
+{
+	std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+	connection.finished[job.sequence] = job;
+
+	std::map<uint64_t, ServerJob>::iterator next;
+	while ((next = connection.finished.find(connection.nextAnswer)) != connection.finished.end())
+	{
+		const ServerJob& answer = next->second;
+		if (answer.status == SUDOKU_OK)
+		{
+			for (uint16_t i = 0; i < SUDOKU_CELLS; ++i)
+			{
+				connection.output += (char)('0' + answer.solution[i]);
+			}
+		}
+		else
+		{
+			connection.output += getStatusName(answer.status);
+		}
+		connection.output += '\n';
+
+		addLatency(latency, std::chrono::duration_cast<std::chrono::microseconds>(now - answer.received).count());
+		connection.finished.erase(next);
+		++connection.nextAnswer;
+	}
+}
+
+int runServer(uint16_t port, uint32_t threadCount, uint32_t batchSize, uint32_t batchWindowUs)
+{
+	batchSize = (batchSize == 0) ? 1 : batchSize;
+
+	if (threadCount == 0)
+	{
+		threadCount = std::thread::hardware_concurrency();
+		threadCount = (threadCount == 0) ? 1 : threadCount;
+	}
+
+	// Stop on SIGINT or SIGTERM through a descriptor the loop waits on, with the
+	// signals blocked before any solver thread starts so none of them takes one
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &signals, NULL);
+
+	int listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	int reuse = 1;
+	sockaddr_in address;
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	address.sin_port = htons(port);
+
+	if (listener < 0 ||
+		setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+		bind(listener, (sockaddr*)&address, sizeof(address)) != 0 ||
+		listen(listener, SOMAXCONN) != 0)
+	{
+		std::cerr << "Unable to listen on port " << port << ": " << strerror(errno) << std::endl;
+		if (listener >= 0)
+		{
+			close(listener);
+		}
+		return 1;
+	}
+
+	ServerQueues queues;
+	queues.stopping = false;
+	queues.wake = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	int signalDescriptor = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC);
+	int timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	int poll = epoll_create1(EPOLL_CLOEXEC);
+
+	epoll_event event;
+	event.events = EPOLLIN;
+	event.data.u64 = LISTEN_ID;
+	epoll_ctl(poll, EPOLL_CTL_ADD, listener, &event);
+	event.data.u64 = WAKE_ID;
+	epoll_ctl(poll, EPOLL_CTL_ADD, queues.wake, &event);
+	event.data.u64 = SIGNAL_ID;
+	epoll_ctl(poll, EPOLL_CTL_ADD, signalDescriptor, &event);
+	event.data.u64 = TIMER_ID;
+	epoll_ctl(poll, EPOLL_CTL_ADD, timer, &event);
+
+	std::vector<std::thread> solvers;
+	for (uint32_t t = 0; t < threadCount; ++t)
+	{
+		solvers.emplace_back(runSolver, std::ref(queues));
+	}
+
+	std::cerr << "Listening on 127.0.0.1:" << port << " with " << threadCount << " solver threads, batches of up to " <<
+		batchSize << " within " << batchWindowUs << "us" << std::endl;
+
+	// Connections are keyed by id rather than socket, so answers for a closed
+	// connection can never reach a new one that reuses its socket
+	std::unordered_map<uint64_t, ServerConnection> connections;
+	uint64_t nextId = FIRST_CONNECTION_ID;
+	uint64_t numConnections = 0;
+	uint64_t numRequests = 0;
+	uint64_t numBatches = 0;
+	LatencyStats latency;
+	memset(&latency, 0, sizeof(latency));
+
+	// Set while requests wait for more to join their batch
+	bool timerArmed = false;
+
+	std::vector<char> buffer(SERVER_READ_SIZE);
+	std::vector<ServerJob> jobs;
+	std::vector<ServerJob> done;
+	epoll_event events[SERVER_MAX_EVENTS];
+	bool running = true;
+
+	while (running)
+	{
+		int count = epoll_wait(poll, events, SERVER_MAX_EVENTS, -1);
+		if (count < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			std::cerr << "Event loop failed: " << strerror(errno) << std::endl;
+			break;
+		}
+
+		for (int e = 0; e < count; ++e)
+		{
+			uint64_t id = events[e].data.u64;
+
+			if (id == SIGNAL_ID)
+			{
+				running = false;
+			}
+			else if (id == TIMER_ID)
+			{
+				uint64_t expirations;
+				ssize_t n = read(timer, &expirations, sizeof(expirations));
+				(void)n;
+
+				timerArmed = false;
+				numBatches += dispatchJobs(queues, jobs, 0, jobs.size(), batchSize);
+			}
+			else if (id == LISTEN_ID)
+			{
+				int socket;
+				while ((socket = accept4(listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+				{
+					ServerConnection& connection = connections[nextId];
+					connection.socket = socket;
+					connection.nextRequest = 0;
+					connection.nextAnswer = 0;
+					connection.events = EPOLLIN;
+					connection.readClosed = false;
+
+					epoll_event added;
+					added.events = EPOLLIN;
+					added.data.u64 = nextId++;
+					epoll_ctl(poll, EPOLL_CTL_ADD, socket, &added);
+					++numConnections;
+				}
+			}
+			else if (id == WAKE_ID)
+			{
+				uint64_t value;
+				ssize_t n = read(queues.wake, &value, sizeof(value));
+				(void)n;
+
+				{
+					std::lock_guard<std::mutex> guard(queues.lock);
+					done.swap(queues.done);
+				}
+
+				for (size_t j = 0; j < done.size(); ++j)
+				{
+					std::unordered_map<uint64_t, ServerConnection>::iterator found = connections.find(done[j].connection);
+					if (found != connections.end())
+					{
+						addAnswer(found->second, done[j], latency);
+					}
+				}
+
+				// Try each connection answered to once, however many answers it got
+				for (size_t j = 0; j < done.size(); ++j)
+				{
+					std::unordered_map<uint64_t, ServerConnection>::iterator found = connections.find(done[j].connection);
+					if (found == connections.end())
+					{
+						continue;
+					}
+
+					ServerConnection& connection = found->second;
+					bool failed = !connection.output.empty() && !writeOutput(connection);
+					if (failed || (connection.readClosed && connection.output.empty() &&
+						connection.nextAnswer == connection.nextRequest))
+					{
+						close(connection.socket);
+						connections.erase(found);
+						continue;
+					}
+
+					updateEvents(poll, found->first, connection);
+				}
+
+				done.clear();
+			}
+			else
+			{
+				std::unordered_map<uint64_t, ServerConnection>::iterator found = connections.find(id);
+				if (found == connections.end())
+				{
+					continue;
+				}
+
+				// A reset connection can take no more answers
+				ServerConnection& connection = found->second;
+				bool ok = (events[e].events & (EPOLLERR | EPOLLHUP)) == 0;
+				if (ok && (events[e].events & EPOLLOUT))
+				{
+					ok = writeOutput(connection);
+				}
+
+				size_t jobCount = jobs.size();
+				if (ok && (events[e].events & EPOLLIN) && !connection.readClosed)
+				{
+					ok = readInput(connection, id, jobs, buffer);
+				}
+
+				// Nothing from a failed connection is worth solving
+				if (!ok)
+				{
+					jobs.resize(jobCount);
+				}
+				numRequests += jobs.size() - jobCount;
+
+				if (!ok || (connection.readClosed && connection.output.empty() &&
+					connection.nextAnswer == connection.nextRequest))
+				{
+					close(connection.socket);
+					connections.erase(found);
+					continue;
+				}
+
+				updateEvents(poll, id, connection);
+			}
+		}
+
+		// Full batches go at once, the rest wait out the window for more requests to join them
+		size_t fullBatches = jobs.size() - jobs.size() % batchSize;
+		if (fullBatches > 0 || batchWindowUs == 0)
+		{
+			numBatches += dispatchJobs(queues, jobs, 0, (batchWindowUs == 0) ? jobs.size() : fullBatches, batchSize);
+		}
+
+		if (!jobs.empty() && !timerArmed)
+		{
+			itimerspec window;
+			memset(&window, 0, sizeof(window));
+			window.it_value.tv_sec = batchWindowUs / 1000000;
+			window.it_value.tv_nsec = (long)(batchWindowUs % 1000000) * 1000;
+			timerfd_settime(timer, 0, &window, NULL);
+			timerArmed = true;
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(queues.lock);
+		queues.stopping = true;
+	}
+	queues.ready.notify_all();
+
+	for (size_t t = 0; t < solvers.size(); ++t)
+	{
+		solvers[t].join();
+	}
+
+	for (std::unordered_map<uint64_t, ServerConnection>::iterator c = connections.begin(); c != connections.end(); ++c)
+	{
+		close(c->second.socket);
+	}
+
+	close(poll);
+	close(timer);
+	close(signalDescriptor);
+	close(queues.wake);
+	close(listener);
+
+	std::cerr << "Connections: " << numConnections << std::endl;
+	std::cerr << "Requests: " << numRequests << std::endl;
+	std::cerr << "Batches: " << numBatches << std::endl;
+	if (latency.count > 0)
+	{
+		std::cerr << "Mean Latency: " << latency.totalUs / latency.count << "us" << std::endl;
+		std::cerr << "Median Latency: <" << getLatencyPercentile(latency, 0.5) << "us" << std::endl;
+		std::cerr << "99th Percentile Latency: <" << getLatencyPercentile(latency, 0.99) << "us" << std::endl;
+		std::cerr << "Max Latency: " << latency.maxUs << "us" << std::endl;
+	}
+
+	return 0;
+}
+
+#else
+
+int runServer(uint16_t, uint32_t, uint32_t, uint32_t)
+{
+	std::cerr << "Server mode is only available on Linux" << std::endl;
+	return 1;
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include <stdint.h>
+
+// Serve puzzles over TCP on 127.0.0.1:port until interrupted (SIGINT or SIGTERM).
+//
+// Each request is a line holding an 81 character puzzle, and is answered with a
+// line holding its solution, or "no solution", "budget exceeded" or "invalid". Blank lines are
+// ignored. Answers on a connection come back in the order the requests were
+// sent, and a client may send many requests before reading any answers.
+//
+// One thread runs a non-blocking epoll loop over every connection, handing
+// puzzles to a pool of solver threads. The solver threads live as long as the
+// server, so the solver state each keeps is only built once.
+//
+// Requests are handed over in batches, solved by one call each: a batch goes as
+// soon as it has batchSize requests, or batchWindowUs after its first request
+// arrived. A window of 0 sends whatever one pass of the event loop read. The
+// time from reading each request to answering it is summarised on exit.
+//
+// Returns 0 once stopped, or 1 if the server could not start. Only available on Linux.
+int runServer(uint16_t port, uint32_t threadCount, uint32_t batchSize = 32, uint32_t batchWindowUs = 100);
+
+#endif
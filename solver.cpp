@@ -0,0 +1,2602 @@
+#include <atomic>
+#include <chrono>
+
+#include <iostream>
+#include <iomanip>
+
+#include "overlay.hpp"
+#include "solver.hpp"
+
+thread_local uint16_t grid[NUM_CELLS];
+
+// 1-Index array of bit values for each number
+const uint16_t NUMBERS[10] =
+{
+	0,
+	0x0002,
+	0x0004,
+	0x0008,
+	0x0010,
+	0x0020,
+	0x0040,
+	0x0080,
+	0x0100,
+	0x0200
+};
+
+const uint16_t ROW_INDEX[NUM_CELLS] =
+{
+	0, 0, 0, 0, 0, 0, 0, 0, 0,
+	1, 1, 1, 1, 1, 1, 1, 1, 1,
+	2, 2, 2, 2, 2, 2, 2, 2, 2,
+	3, 3, 3, 3, 3, 3, 3, 3, 3,
+	4, 4, 4, 4, 4, 4, 4, 4, 4,
+	5, 5, 5, 5, 5, 5, 5, 5, 5,
+	6, 6, 6, 6, 6, 6, 6, 6, 6,
+	7, 7, 7, 7, 7, 7, 7, 7, 7,
+	8, 8, 8, 8, 8, 8, 8, 8, 8
+};
+
+const uint16_t COL_INDEX[NUM_CELLS] =
+{
+	0, 1, 2, 3, 4, 5, 6, 7, 8,
+	0, 1, 2, 3, 4, 5, 6, 7, 8,
+	0, 1, 2, 3, 4, 5, 6, 7, 8,
+	0, 1, 2, 3, 4, 5, 6, 7, 8,
+	0, 1, 2, 3, 4, 5, 6, 7, 8,
+	0, 1, 2, 3, 4, 5, 6, 7, 8,
+	0, 1, 2, 3, 4, 5, 6, 7, 8,
+	0, 1, 2, 3, 4, 5, 6, 7, 8,
+	0, 1, 2, 3, 4, 5, 6, 7, 8
+};
+
+// Index of top left of each Box
+const uint16_t BOX_FIRST_INDEX[NUM_CELLS] =
+{
+	 0,  0,  0,  3,  3,  3,  6,  6,  6,
+	 0,  0,  0,  3,  3,  3,  6,  6,  6,
+	 0,  0,  0,  3,  3,  3,  6,  6,  6,
+	27, 27, 27, 30, 30, 30, 33, 33, 33,
+	27, 27, 27, 30, 30, 30, 33, 33, 33,
+	27, 27, 27, 30, 30, 30, 33, 33, 33,
+	54, 54, 54, 57, 57, 57, 60, 60, 60,
+	54, 54, 54, 57, 57, 57, 60, 60, 60,
+	54, 54, 54, 57, 57, 57, 60, 60, 60
+};
+
+// Index of box 0 - 8
+const uint16_t BOX_INDEX[NUM_CELLS] =
+{
+	0, 0, 0, 1, 1, 1, 2, 2, 2,
+	0, 0, 0, 1, 1, 1, 2, 2, 2,
+	0, 0, 0, 1, 1, 1, 2, 2, 2,
+	3, 3, 3, 4, 4, 4, 5, 5, 5,
+	3, 3, 3, 4, 4, 4, 5, 5, 5,
+	3, 3, 3, 4, 4, 4, 5, 5, 5,
+	6, 6, 6, 7, 7, 7, 8, 8, 8,
+	6, 6, 6, 7, 7, 7, 8, 8, 8,
+	6, 6, 6, 7, 7, 7, 8, 8, 8
+};
+
+// Row/Col Index for Each box
+const uint16_t BOX_ROW[BOXES] =
+{
+	0,  0,  0,
+	3,  3,  3,
+	6,  6,  6
+};
+const uint16_t BOX_COL[BOXES] =
+{
+	0,  3,  6,
+	0,  3,  6,
+	0,  3,  6
+};
+
+// Statistics
+thread_local uint64_t numReads = 0;
+thread_local uint64_t numWrites = 0;
+
+// Profiling statistics for a solving technique
+struct TechniqueStats
+{
+	uint64_t calls;
+	uint64_t hits;
+	uint64_t skips;
+	uint64_t writes;
+	uint64_t timeNs;
+};
+
+// A solving technique run by the solve loop
+struct Technique
+{
+	const char* name;
+	bool (*check)();
+
+	// Techniques are only tried once every technique in an earlier tier has stopped making progress
+	uint16_t tier;
+
+	// Statistics for the current solve, and over every solve so far
+	TechniqueStats solveStats;
+	TechniqueStats totalStats;
+
+	// Set by the adaptive scheduler for techniques that have not been paying off
+	bool skipped;
+};
+
+thread_local Technique techniques[] =
+{
+	{ "Cells",          checkCells,         0 },
+	{ "Boxes",          checkBoxes,         0 },
+	{ "Rows",           checkRows,          0 },
+	{ "Cols",           checkCols,          0 },
+	{ "Naked Rows",     checkNakedRows,     1 },
+	{ "Naked Cols",     checkNakedCols,     1 },
+	{ "Naked Boxes",    checkNakedBoxes,    1 },
+	{ "Hidden Rows",    checkHiddenRows,    2 },
+	{ "Hidden Cols",    checkHiddenCols,    2 },
+	{ "Hidden Boxes",   checkHiddenBoxes,   2 },
+	{ "Hidden Rows V2", checkHiddenRowsV2,  3 },
+	{ "Hidden Cols V2", checkHiddenColsV2,  3 },
+	{ "Hidden Boxes V2",checkHiddenBoxesV2, 3 },
+	{ "X-Wing",         checkXWings,        4 },
+	{ "Swordfish",      checkSwordfish,     4 },
+	{ "Jellyfish",      checkJellyfish,     4 },
+	{ "XY-Wing",        checkXYWings,       5 },
+	{ "XYZ-Wing",       checkXYZWings,      5 },
+	{ "Coloring",       checkColoring,      5 },
+	{ "Pattern Overlay",checkPatternOverlay,6 }
+};
+
+static const uint16_t NUM_TECHNIQUES = sizeof(techniques) / sizeof(techniques[0]);
+
+// Order the solve loop tries techniques in, as indexes into techniques[]
+struct TechniqueOrder
+{
+	uint16_t order[NUM_TECHNIQUES];
+
+	TechniqueOrder()
+	{
+		for (uint16_t t = 0; t < NUM_TECHNIQUES; ++t)
+		{
+			order[t] = t;
+		}
+	}
+
+	uint16_t& operator[](uint16_t i)
+	{
+		return order[i];
+	}
+};
+
+static thread_local TechniqueOrder techniqueOrder;
+
+std::atomic<bool> adaptiveOrdering(false);
+
+// A technique is only skipped once it has been tried this many times without any progress
+static const uint64_t ADAPTIVE_MIN_CALLS = 500;
+
+// Skipped techniques are still run every this many solves, in case the puzzles change
+static const uint32_t ADAPTIVE_PROBE_INTERVAL = 64;
+
+thread_local uint32_t solveCount = 0;
+
+// Limits on each solve, 0 for none, and whether the last solve ran into them
+static thread_local uint64_t maxSolveSteps = 0;
+static thread_local uint64_t maxSolveMicroseconds = 0;
+static thread_local bool solveLimitExceeded = false;
+static thread_local uint64_t solveSteps = 0;
+
+// Units tracked for changes: rows, then columns, then boxes
+static const uint16_t ROW_UNITS = 0;
+static const uint16_t COL_UNITS = ROWS;
+static const uint16_t BOX_UNITS = ROWS + COLS;
+static const uint16_t NUM_UNITS = ROWS + COLS + BOXES;
+
+// Techniques that only look inside one unit at a time, and so can skip units
+// that have not changed since they last looked
+enum UnitTechnique
+{
+	NAKED_ROWS,
+	NAKED_COLS,
+	NAKED_BOXES,
+	HIDDEN_ROWS,
+	HIDDEN_COLS,
+	HIDDEN_BOXES,
+	HIDDEN_ROWS_V2,
+	HIDDEN_COLS_V2,
+	HIDDEN_BOXES_V2,
+	NUM_UNIT_TECHNIQUES
+};
+
+// Bumped whenever a cell of a unit changes
+thread_local uint32_t unitVersions[NUM_UNITS];
+
+// The version of each unit when each technique last started looking at it
+thread_local uint32_t unitsChecked[NUM_UNIT_TECHNIQUES][ROWS];
+
+// Write a cell, marking its units as changed if it is different
+static void setCell(uint16_t idx, uint16_t value)
+{
+	if (grid[idx] != value)
+	{
+		grid[idx] = value;
+		++unitVersions[ROW_UNITS + ROW_INDEX[idx]];
+		++unitVersions[COL_UNITS + COL_INDEX[idx]];
+		++unitVersions[BOX_UNITS + BOX_INDEX[idx]];
+	}
+}
+
+// Get a bitmap of which of the 9 units from firstUnit have changed since a technique
+// last looked at them, and note them as looked at now
+static uint16_t getChangedUnits(UnitTechnique technique, uint16_t firstUnit)
+{
+	uint16_t changed = 0;
+
+	for (uint16_t u = 0; u < ROWS; ++u)
+	{
+		uint32_t version = unitVersions[firstUnit + u];
+		if (unitsChecked[technique][u] != version)
+		{
+			unitsChecked[technique][u] = version;
+			changed |= 1 << u;
+		}
+	}
+
+	return changed;
+}
+
+// Forget what every technique has looked at, as the grid may have been loaded since
+static void resetChangedUnits()
+{
+	for (uint16_t u = 0; u < NUM_UNITS; ++u)
+	{
+		unitVersions[u] = 1;
+	}
+
+	for (uint16_t t = 0; t < NUM_UNIT_TECHNIQUES; ++t)
+	{
+		for (uint16_t u = 0; u < ROWS; ++u)
+		{
+			unitsChecked[t][u] = 0;
+		}
+	}
+}
+
+// Run a single technique, recording its statistics
+bool runTechnique(uint16_t t);
+
+// Sort the techniques in each tier by writes per microsecond over every solve so far,
+// and pick out techniques to skip
+void scheduleTechniques();
+
+// Fill in the technique statistics of a metrics record from the last solve
+void getTechniqueMetrics(SolveMetrics& metrics)
+{
+	metrics.numTechniques = NUM_TECHNIQUES;
+	for (uint16_t t = 0; t < NUM_TECHNIQUES; ++t)
+	{
+		const TechniqueStats& stats = techniques[t].solveStats;
+		metrics.techniques[t].name = techniques[t].name;
+		metrics.techniques[t].calls = stats.calls;
+		metrics.techniques[t].hits = stats.hits;
+		metrics.techniques[t].writes = stats.writes;
+		metrics.techniques[t].timeNs = stats.timeNs;
+	}
+}
+
+// Clear the grid and place the givens of a puzzle (1-9, 0 for blanks)
+template <typename Cell>
+static void loadGivens(const Cell* board)
+{
+	// Initialze each cell to 0b0000 0011 1111 1110 to represent all cells have all posibilities
+	for (uint16_t i = 0; i < NUM_CELLS; ++i)
+	{
+		grid[i] = 0x03FE;
+	}
+
+	for (uint16_t i = 0; i < NUM_CELLS; ++i)
+	{
+		if (board[i] != 0)
+		{
+			updateCell(i, board[i], true);
+		}
+	}
+}
+
+void loadGrid(const int* board)
+{
+	loadGivens(board);
+}
+
+void loadGrid(const uint8_t* digits)
+{
+	loadGivens(digits);
+}
+
+// Check that every cell of the grid has been solved
+bool isGridSolved()
+{
+	for (uint16_t i = 0; i < NUM_CELLS; ++i)
+	{
+		if ((grid[i] & SOLVED) == 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void getGridDigits(uint8_t* digits)
+{
+	for (uint16_t i = 0; i < NUM_CELLS; ++i)
+	{
+		digits[i] = (grid[i] & SOLVED) ? (uint8_t)(grid[i] & ~SOLVED) : 0;
+	}
+}
+
+// Run the solving techniques until none of them can make any progress
+void solveGrid()
+{
+	for (uint16_t t = 0; t < NUM_TECHNIQUES; ++t)
+	{
+		techniques[t].solveStats = TechniqueStats();
+	}
+
+	if (adaptiveOrdering)
+	{
+		scheduleTechniques();
+	}
+
+	resetChangedUnits();
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(maxSolveMicroseconds);
+	uint64_t steps = 0;
+	solveLimitExceeded = false;
+
+	// Start again from the cheapest technique whenever any technique updates the grid
+	bool updatedCells = true;
+	while (updatedCells)
+	{
+		updatedCells = false;
+
+		for (uint16_t i = 0; i < NUM_TECHNIQUES && !updatedCells; ++i)
+		{
+			updatedCells = runTechnique(techniqueOrder[i]);
+			++steps;
+		}
+
+		// The clock is only read once per pass, as every technique already reads it twice
+		if (updatedCells && ((maxSolveSteps != 0 && steps >= maxSolveSteps) ||
+			(maxSolveMicroseconds != 0 && std::chrono::steady_clock::now() >= deadline)))
+		{
+			solveLimitExceeded = true;
+			break;
+		}
+	}
+
+	solveSteps = steps;
+
+	for (uint16_t t = 0; t < NUM_TECHNIQUES; ++t)
+	{
+		TechniqueStats& solve = techniques[t].solveStats;
+		TechniqueStats& total = techniques[t].totalStats;
+		total.calls += solve.calls;
+		total.hits += solve.hits;
+		total.skips += solve.skips;
+		total.writes += solve.writes;
+		total.timeNs += solve.timeNs;
+	}
+
+	++solveCount;
+}
+
+// Cut each later solve on this thread short after maxSteps technique runs or maxMicroseconds
+void setSolveLimits(uint64_t maxSteps, uint64_t maxMicroseconds)
+{
+	maxSolveSteps = maxSteps;
+	maxSolveMicroseconds = maxMicroseconds;
+}
+
+// Check whether the last solve was cut short by the limits
+bool isSolveLimitExceeded()
+{
+	return solveLimitExceeded;
+}
+
+// Get the number of technique runs the last solve took
+uint64_t getSolveSteps()
+{
+	return solveSteps;
+}
+
+// Run a single technique, recording its statistics
+bool runTechnique(uint16_t t)
+{
+	Technique& technique = techniques[t];
+
+	if (technique.skipped)
+	{
+		++technique.solveStats.skips;
+		return false;
+	}
+
+	uint64_t writesBefore = numWrites;
+	auto start = std::chrono::high_resolution_clock::now();
+
+	bool updatedCells = technique.check();
+
+	auto stop = std::chrono::high_resolution_clock::now();
+
+	++technique.solveStats.calls;
+	if (updatedCells)
+	{
+		++technique.solveStats.hits;
+	}
+	technique.solveStats.writes += numWrites - writesBefore;
+	technique.solveStats.timeNs += std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+
+	return updatedCells;
+}
+
+// Writes per microsecond, with untried techniques first so they get measured
+double getTechniqueYield(const TechniqueStats& stats)
+{
+	if (stats.calls == 0)
+	{
+		return 1e9;
+	}
+
+	return (stats.writes * 1000.0) / (stats.timeNs + 1);
+}
+
+// Sort the techniques in each tier by writes per microsecond over every solve so far,
+// and pick out techniques to skip
+void scheduleTechniques()
+{
+	// Insertion sort, keeping tiers in order
+	for (uint16_t i = 1; i < NUM_TECHNIQUES; ++i)
+	{
+		uint16_t t = techniqueOrder[i];
+		double yield = getTechniqueYield(techniques[t].totalStats);
+
+		uint16_t j = i;
+		while (j > 0)
+		{
+			const Technique& prev = techniques[techniqueOrder[j - 1]];
+			if (prev.tier != techniques[t].tier ||
+				getTechniqueYield(prev.totalStats) >= yield)
+			{
+				break;
+			}
+
+			techniqueOrder[j] = techniqueOrder[j - 1];
+			--j;
+		}
+		techniqueOrder[j] = t;
+	}
+
+	for (uint16_t t = 0; t < NUM_TECHNIQUES; ++t)
+	{
+		const TechniqueStats& stats = techniques[t].totalStats;
+		techniques[t].skipped = stats.calls >= ADAPTIVE_MIN_CALLS &&
+			stats.hits == 0 &&
+			solveCount % ADAPTIVE_PROBE_INTERVAL != 0;
+	}
+}
+
+// Print where time was spent over every solve so far
+void printTechniqueReport(std::ostream& out)
+{
+	uint64_t totalNs = 0;
+	for (uint16_t t = 0; t < NUM_TECHNIQUES; ++t)
+	{
+		totalNs += techniques[t].totalStats.timeNs;
+	}
+
+	out << std::endl;
+	out << std::left << std::setw(16) << "Technique" << std::right
+		<< std::setw(5) << "Tier"
+		<< std::setw(10) << "Calls"
+		<< std::setw(10) << "Hits"
+		<< std::setw(10) << "Skips"
+		<< std::setw(10) << "Writes"
+		<< std::setw(12) << "Time (us)"
+		<< std::setw(8) << "Time %"
+		<< std::setw(12) << "Writes/us" << std::endl;
+
+	// Report in the order the solve loop tries them
+	for (uint16_t i = 0; i < NUM_TECHNIQUES; ++i)
+	{
+		const Technique& technique = techniques[techniqueOrder[i]];
+		const TechniqueStats& stats = technique.totalStats;
+
+		out << std::left << std::setw(16) << technique.name << std::right
+			<< std::setw(5) << technique.tier
+			<< std::setw(10) << stats.calls
+			<< std::setw(10) << stats.hits
+			<< std::setw(10) << stats.skips
+			<< std::setw(10) << stats.writes
+			<< std::setw(12) << stats.timeNs / 1000
+			<< std::setw(8) << std::fixed << std::setprecision(1) << (totalNs == 0 ? 0.0 : stats.timeNs * 100.0 / totalNs)
+			<< std::setw(12) << std::setprecision(3) << (stats.timeNs == 0 ? 0.0 : stats.writes * 1000.0 / stats.timeNs)
+			<< std::defaultfloat << std::endl;
+	}
+	out << std::endl;
+}
+
+// Get the number from a cell with only 1 bit set
+uint16_t getNumber(uint16_t cellValue)
+{
+	// Loop through all 16 bits
+	for (int i = 0; i < 16; ++i)
+	{
+		if (((cellValue >> i) & 0x1) == 1)
+		{
+			return i;
+		}
+	}
+
+	// ERROR CASE
+	return 0;
+}
+
+uint16_t getIndex(uint16_t i, uint16_t j)
+{
+	return (i * ROWS) + j;
+}
+
+// Get the top left index for a given cells box
+uint16_t getBox(uint16_t row, uint16_t col)
+{
+	uint16_t idx = getIndex(row, col);
+
+	return BOX_FIRST_INDEX[idx];
+}
+
+// Set a given cell to a given value, and update all possibilities
+void updateCell(uint16_t row, uint16_t col, uint16_t value, bool init)
+{
+	setCell(getIndex(row, col), SOLVED | value);
+	++numWrites;
+
+	updateRow(row, col, value, init);
+	updateCol(row, col, value, init);
+	updateBox(row, col, value, init);
+}
+
+void updateCell(uint16_t idx, uint16_t value, bool init)
+{
+	uint16_t row = ROW_INDEX[idx];
+	uint16_t col = COL_INDEX[idx];
+
+	updateCell(row, col, value, init);
+}
+
+void updateRow(uint16_t row, uint16_t col, uint16_t value, bool init)
+{
+	for (uint16_t c = 0; c < COLS; ++c)
+	{
+		uint16_t idx = getIndex(row, c);
+		// Only update un-solved cells
+		++numReads;
+		if ((grid[idx] & SOLVED) == 0)
+		{
+			// Bitwise AND with the ones compiment of the value to switch off only that bit
+			setCell(idx, grid[idx] & ~(NUMBERS[value]));
+			++numWrites;
+
+			// Check if there is now only one possible value for this cell
+			if (!init)
+			{
+				checkCell(idx);
+			}
+		}
+	}
+}
+
+void updateCol(uint16_t row, uint16_t col, uint16_t value, bool init)
+{
+	for (uint16_t r = 0; r < ROWS; ++r)
+	{
+		uint16_t idx = getIndex(r, col);
+		// Only update un-solved cells
+		++numReads;
+		if ((grid[idx] & SOLVED) == 0)
+		{
+			// Bitwise AND with the ones compiment of the value to switch off only that bit
+			setCell(idx, grid[idx] & ~(NUMBERS[value]));
+			++numWrites;
+
+			// Check if there is now only one possible value for this cell
+			if (!init)
+			{
+				checkCell(idx);
+			}
+		}
+	}
+}
+
+void updateBox(uint16_t row, uint16_t col, uint16_t value, bool init)
+{
+	// Get the index of the top left of this box
+	uint16_t box = getBox(row, col);
+
+	// Get the Row of the first box cell
+	uint16_t startRow = ROW_INDEX[box];
+
+	// Get the Col of the first box cell
+	uint16_t startCol = COL_INDEX[box];
+
+	for (uint16_t r = startRow; r < startRow + DIMENSION; ++r)
+	{
+		for (uint16_t c = startCol; c < startCol + DIMENSION; ++c)
+		{
+			uint16_t idx = getIndex(r, c);
+			// Only update un-solved cells
+			++numReads;
+			if ((grid[idx] & SOLVED) == 0)
+			{
+				// Bitwise AND with the ones compiment of the value to switch off only that bit
+				setCell(idx, grid[idx] & ~(NUMBERS[value]));
+				++numWrites;
+
+				// Check if there is now only one possible value for this cell
+				if (!init)
+				{
+					checkCell(idx);
+				}
+			}
+		}
+	}
+}
+
+// Check all Rows/Cols/Boxes for any last possible values
+bool checkCell(uint16_t idx)
+{
+	++numReads;
+	uint16_t value = grid[idx];
+
+	// Only calculate on un-solved cells
+	if ((value & SOLVED) != SOLVED)
+	{
+		// If only 1 bit is set
+		if (popCount(value) == 1)
+		{
+			updateCell(idx, getNumber(value));
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool checkCells()
+{
+	bool anyCellsUpdated = false;
+
+	bool updatedCell = true;
+	while (updatedCell)
+	{
+		updatedCell = false;
+
+		for (uint16_t i = 0; i < NUM_CELLS; ++i)
+		{
+			updatedCell = checkCell(i);
+			if (updatedCell)
+			{
+				anyCellsUpdated = true;
+			}
+		}
+	}
+
+	return anyCellsUpdated;
+}
+
+bool checkRows()
+{
+	bool anyCellsUpdated = false;
+	// Check for any cells that are the only remaining option for the Row
+	uint16_t last = NUM_CELLS;
+	bool updatedCell = true;
+	while (updatedCell)
+	{
+		updatedCell = false;
+
+		// For Each Row
+		for (uint16_t i = 0; i < COLS; ++i)
+		{
+			// For each value
+			for (uint16_t val = 1; val < 10; ++val)
+			{
+				// If there is a single cell that is the last possibility for this value
+				last = getLastInRow(i, val);
+				if (last != NUM_CELLS)
+				{
+					updateCell(last, val);
+					updatedCell = true;
+					anyCellsUpdated = true;
+				}
+			}
+
+		}
+	}
+
+	return anyCellsUpdated;
+}
+
+bool checkCols()
+{
+	bool anyCellsUpdated = false;
+	// Check for any cells that are the only remaining option for the Col
+	uint16_t last = NUM_CELLS;
+	bool updatedCell = true;
+	while (updatedCell)
+	{
+		updatedCell = false;
+
+		// For Each Col
+		for (uint16_t i = 0; i < COLS; ++i)
+		{
+			// For each value
+			for (uint16_t val = 1; val < 10; ++val)
+			{
+				// If there is a single cell that is the last possibility for this value
+				last = getLastInCol(i, val);
+				if (last != NUM_CELLS)
+				{
+					updateCell(last, val);
+					updatedCell = true;
+					anyCellsUpdated = true;
+				}
+			}
+		}
+	}
+
+	return anyCellsUpdated;
+}
+
+bool checkBoxes()
+{
+	bool anyCellsUpdated = false;
+	// Check for any cells that are the only remaining option for the Box
+	uint16_t last = NUM_CELLS;
+	bool updatedCell = true;
+	while (updatedCell)
+	{
+		updatedCell = false;
+
+		// For Each Box
+		for (uint16_t i = 0; i < BOXES; ++i)
+		{
+			// For each value
+			for (uint16_t val = 1; val < 10; ++val)
+			{
+				// If there is a single cell that is the last possibility for this value
+				last = getLastInBox(i, val);
+				if (last != NUM_CELLS)
+				{
+					updateCell(last, val);
+					updatedCell = true;
+					anyCellsUpdated = true;
+				}
+			}
+		}
+	}
+
+	return anyCellsUpdated;
+}
+
+uint16_t getLastInRow(uint16_t row, uint16_t value)
+{
+	uint16_t count = 0;
+	uint16_t index = NUM_CELLS;
+
+	for (uint16_t c = 0; c < COLS; ++c)
+	{
+		uint16_t idx = getIndex(row, c);
+
+		// Check if a solved cell matches the value
+		++numReads;
+		uint16_t gridValue = grid[idx];
+
+		if ((gridValue & SOLVED) == SOLVED)
+		{
+			if ((gridValue & ~(SOLVED)) == value)
+			{
+				return NUM_CELLS;
+			}
+		}
+		// Check if an un-solved cell is able to be that value
+		else
+		{
+			if ((gridValue & NUMBERS[value]) == NUMBERS[value])
+			{
+				index = idx;
+				++count;
+			}
+		}
+	}
+
+	// If there was only one possibility found
+	if (count == 1)
+	{
+		return index;
+	}
+
+	return NUM_CELLS;
+}
+
+uint16_t getLastInCol(uint16_t col, uint16_t value)
+{
+	uint16_t count = 0;
+	uint16_t index = NUM_CELLS;
+
+	for (uint16_t r = 0; r < ROWS; ++r)
+	{
+		uint16_t idx = getIndex(r, col);
+
+		// Check if a solved cell matches the value
+		++numReads;
+		uint16_t gridValue = grid[idx];
+
+		if ((gridValue & SOLVED) == SOLVED)
+		{
+			if ((gridValue & ~(SOLVED)) == value)
+			{
+				return NUM_CELLS;
+			}
+		}
+		// Check if an un-solved cell is able to be that value
+		else
+		{
+			if ((gridValue & NUMBERS[value]) == NUMBERS[value])
+			{
+				index = idx;
+				++count;
+			}
+		}
+	}
+
+	// If there was only one possibility found
+	if (count == 1)
+	{
+		return index;
+	}
+
+	return NUM_CELLS;
+}
+
+uint16_t getLastInBox(uint16_t box, uint16_t value)
+{
+	uint16_t count = 0;
+	uint16_t index = NUM_CELLS;
+
+	// Get the Row of the first box cell
+	uint16_t startRow = BOX_ROW[box];
+
+	// Get the Col of the first box cell
+	uint16_t startCol = BOX_COL[box];
+
+	for (uint16_t r = startRow; r < startRow + DIMENSION; ++r)
+	{
+		for (uint16_t c = startCol; c < startCol + DIMENSION; ++c)
+		{
+			uint16_t idx = getIndex(r, c);
+
+			// Check if a solved cell matches the value
+			++numReads;
+			uint16_t gridValue = grid[idx];
+
+			if ((gridValue & SOLVED) == SOLVED)
+			{
+				if ((gridValue & ~(SOLVED)) == value)
+				{
+					return NUM_CELLS;
+				}
+			}
+			// Check if an un-solved cell is able to be that value
+			else
+			{
+				if ((gridValue & NUMBERS[value]) == NUMBERS[value])
+				{
+					index = idx;
+					++count;
+				}
+			}
+		}
+	}
+
+	// If there was only one possibility found
+	if (count == 1)
+	{
+		return index;
+	}
+
+	return NUM_CELLS;
+}
+
+// Check for Naked Pairs
+bool checkNakedBoxes()
+{
+	bool anyCellsUpdated = false;
+
+	// Only units changed since this last ran can turn up anything new
+	uint16_t changed = getChangedUnits(NAKED_BOXES, BOX_UNITS);
+	if (changed == 0)
+	{
+		return false;
+	}
+
+	// For Each Box
+	for (uint16_t b = 0; b < BOXES; ++b)
+	{
+		if (((changed >> b) & 0x1) == 0)
+		{
+			continue;
+		}
+
+		// Get the Row of the first box cell
+		uint16_t startRow = BOX_ROW[b];
+
+		// Get the Col of the first box cell
+		uint16_t startCol = BOX_COL[b];
+
+		// For each value
+		for (uint16_t val = 1; val < 10; ++val)
+		{
+			uint16_t lastPossibleRow = ROWS;
+			bool sameRow = false;
+			bool diffRows = false;
+
+			uint16_t lastPossibleCol = COLS;
+			bool sameCol = false;
+			bool diffCols = false;
+
+
+			//  For Each cell in Box
+			for (uint16_t r = startRow; r < startRow + DIMENSION; ++r)
+			{
+				for (uint16_t c = startCol; c < startCol + DIMENSION; ++c)
+				{
+					uint16_t idx = getIndex(r, c);
+
+					// Check if a solved cell matches the value
+					++numReads;
+					uint16_t gridValue = grid[idx];
+
+					// If the Cell if Solved
+					if ((gridValue & SOLVED) == SOLVED)
+					{
+						// If the Cell is solved AND the value to check
+						if ((gridValue & ~(SOLVED)) == val)
+						{
+							// Break out of the "For Each Cell" Loop
+							r = NUM_CELLS;
+							c = NUM_CELLS;
+							sameRow = false;
+						}
+					}
+					// Check if an un-solved cell is able to be that value
+					else
+					{
+						if ((gridValue & NUMBERS[val]) == NUMBERS[val])
+						{
+							// Check Rows
+							if (lastPossibleRow == ROWS)
+							{
+								lastPossibleRow = r;
+							}
+							// If the remaining possibilities for this val are on different rows
+							else if (r != lastPossibleRow)
+							{
+								diffRows = true;
+							}
+							else
+							{
+								sameRow = true;
+							}
+
+							// Check Cols
+							if (lastPossibleCol == COLS)
+							{
+								lastPossibleCol = c;
+							}
+							// If the remaining possibilities for this val are in different Cols
+							else if (c != lastPossibleCol)
+							{
+								diffCols = true;
+							}
+							else
+							{
+								sameCol = true;
+							}
+						}
+
+					} // End If Solved
+				} // End For Col
+			} // End For Row
+
+			// Check if we found a value on the same row
+			if (sameRow && !diffRows)
+			{
+				// Update all other cells in this row (in other boxes)
+				for (uint16_t c = 0; c < COLS; ++c)
+				{
+					uint16_t idx = getIndex(lastPossibleRow, c);
+
+					// SKip over this box
+					if (BOX_INDEX[idx] != b)
+					{
+						// Only update un-solved cells
+						++numReads;
+						uint16_t gridValue = grid[idx];
+						if ((gridValue & SOLVED) == 0 &&
+							(gridValue & NUMBERS[val]) == NUMBERS[val])
+						{
+							// Bitwise AND with the ones compiment of the value to switch off only that bit
+							setCell(idx, grid[idx] & ~(NUMBERS[val]));
+							++numWrites;
+							anyCellsUpdated = true;
+
+							// Check if there is now only one possible value for this cell
+							checkCell(idx);
+						}
+					}
+				}
+			} // End If Same Row
+						// Check if we found a value on the same col
+			if (sameCol && !diffCols)
+			{
+				// Update all other cells in this Col (in other boxes)
+				for (uint16_t r = 0; r < ROWS; ++r)
+				{
+					uint16_t idx = getIndex(r, lastPossibleCol);
+
+					// SKip over this box
+					if (BOX_INDEX[idx] != b)
+					{
+						// Only update un-solved cells
+						++numReads;
+						uint16_t gridValue = grid[idx];
+						if ((gridValue & SOLVED) == 0 &&
+							(gridValue & NUMBERS[val]) == NUMBERS[val])
+						{
+							// Bitwise AND with the ones compiment of the value to switch off only that bit
+							setCell(idx, grid[idx] & ~(NUMBERS[val]));
+							++numWrites;
+							anyCellsUpdated = true;
+
+							// Check if there is now only one possible value for this cell
+							checkCell(idx);
+						}
+					}
+				}
+			} // End If Same Col
+		} // End for Val
+	} // End For Box
+
+	return anyCellsUpdated;
+}
+
+bool checkNakedRows()
+{
+	bool anyCellsUpdated = false;
+
+	// Only units changed since this last ran can turn up anything new
+	uint16_t changed = getChangedUnits(NAKED_ROWS, ROW_UNITS);
+	if (changed == 0)
+	{
+		return false;
+	}
+
+	for (uint16_t r = 0; r < ROWS; ++r)
+	{
+		if (((changed >> r) & 0x1) == 0)
+		{
+			continue;
+		}
+
+		// For each value
+		for (uint16_t val = 1; val < 10; ++val)
+		{
+			uint16_t lastPossibleBox = BOXES;
+			bool sameBox = false;
+			bool diffBoxes = false;
+			bool numberSolved = false;
+
+			for (uint16_t c = 0; c < COLS; ++c)
+			{
+				uint16_t idx = getIndex(r, c);
+
+				// Check if a solved cell matches the value
+				++numReads;
+				uint16_t gridValue = grid[idx];
+
+				// If the Cell if Solved
+				if ((gridValue & SOLVED) == SOLVED)
+				{
+					// If the Cell is solved AND the value to check
+					if ((gridValue & ~(SOLVED)) == val)
+					{
+						numberSolved = true;
+						// Stop checking this value
+						break;
+					}
+				}
+				// Check if an un-solved cell is able to be that value
+				else
+				{
+					if ((gridValue & NUMBERS[val]) == NUMBERS[val])
+					{
+						// Check Rows
+						if (lastPossibleBox == BOXES)
+						{
+							lastPossibleBox = BOX_INDEX[idx];
+						}
+						// If the remaining possibilities for this val are on different rows
+						else if (BOX_INDEX[idx] != lastPossibleBox)
+						{
+							diffBoxes = true;
+							// Stop checking this value
+							break;
+						}
+						else
+						{
+							sameBox = true;
+						}
+					}
+				}
+			}
+
+			if (sameBox && !diffBoxes && !numberSolved)
+			{
+				// Get the Row of the first box cell
+				uint16_t startRow = BOX_ROW[lastPossibleBox];
+
+				// Get the Col of the first box cell
+				uint16_t startCol = BOX_COL[lastPossibleBox];
+
+				for (uint16_t rB = startRow; rB < startRow +DIMENSION; ++rB)
+				{
+					for (uint16_t cB = startCol; cB < startCol + DIMENSION; ++cB)
+					{
+						// Skip over this row
+						if (rB != r)
+						{
+							uint16_t idxB = getIndex(rB, cB);
+
+							// Only update un-solved cells
+							++numReads;
+							uint16_t gridValue = grid[idxB];
+							if ((gridValue & SOLVED) == 0 &&
+								(gridValue & NUMBERS[val]) == NUMBERS[val])
+							{
+								// Bitwise AND with the ones compiment of the value to switch off only that bit
+								setCell(idxB, grid[idxB] & ~(NUMBERS[val]));
+								++numWrites;
+								anyCellsUpdated = true;
+
+								// Check if there is now only one possible value for this cell
+								checkCell(idxB);
+							}
+						}
+					}
+				}
+
+			}
+		}
+	}
+
+	return anyCellsUpdated;			
+}
+
+bool checkNakedCols()
+{
+	bool anyCellsUpdated = false;
+
+	// Only units changed since this last ran can turn up anything new
+	uint16_t changed = getChangedUnits(NAKED_COLS, COL_UNITS);
+	if (changed == 0)
+	{
+		return false;
+	}
+
+	for (uint16_t c = 0; c < COLS; ++c)
+	{
+		if (((changed >> c) & 0x1) == 0)
+		{
+			continue;
+		}
+
+		// For each value
+		for (uint16_t val = 1; val < 10; ++val)
+		{
+
+			uint16_t lastPossibleBox = BOXES;
+			bool sameBox = false;
+			bool diffBoxes = false;
+			bool numberSolved = false;
+
+			for (uint16_t r = 0; r < ROWS; ++r)
+			{
+				uint16_t idx = getIndex(r, c);
+
+				// Check if a solved cell matches the value
+				++numReads;
+				uint16_t gridValue = grid[idx];
+
+				// If the Cell if Solved
+				if ((gridValue & SOLVED) == SOLVED)
+				{
+					// If the Cell is solved AND the value to check
+					if ((gridValue & ~(SOLVED)) == val)
+					{
+						numberSolved = true;
+						// Stop checking this value
+						break;
+					}
+				}
+				// Check if an un-solved cell is able to be that value
+				else
+				{
+					if ((gridValue & NUMBERS[val]) == NUMBERS[val])
+					{
+						// Check Rows
+						if (lastPossibleBox == BOXES)
+						{
+							lastPossibleBox = BOX_INDEX[idx];
+						}
+						// If the remaining possibilities for this val are on different rows
+						else if (BOX_INDEX[idx] != lastPossibleBox)
+						{
+							diffBoxes = true;
+						}
+						else
+						{
+							sameBox = true;
+						}
+					}
+				}
+			}
+
+			if (sameBox && !diffBoxes && !numberSolved)
+			{
+				// Get the Row of the first box cell
+				uint16_t startRow = BOX_ROW[lastPossibleBox];
+
+				// Get the Col of the first box cell
+				uint16_t startCol = BOX_COL[lastPossibleBox];
+
+				for (uint16_t rB = startRow; rB < startRow + DIMENSION; ++rB)
+				{
+					for (uint16_t cB = startCol; cB < startCol + DIMENSION; ++cB)
+					{
+						// Skip over this col
+						if (cB != c)
+						{
+							uint16_t idxB = getIndex(rB, cB);
+
+							// Only update un-solved cells
+							++numReads;
+							uint16_t gridValue = grid[idxB];
+							if ((gridValue & SOLVED) == 0 &&
+								(gridValue & NUMBERS[val]) == NUMBERS[val])
+							{
+								// Bitwise AND with the ones compiment of the value to switch off only that bit
+								setCell(idxB, grid[idxB] & ~(NUMBERS[val]));
+								++numWrites;
+								anyCellsUpdated = true;
+
+								// Check if there is now only one possible value for this cell
+								checkCell(idxB);
+							}
+						}
+					}
+				}
+
+			}
+		}
+	}
+
+	return anyCellsUpdated;
+}
+
+bool checkHiddenBoxes()
+{
+	bool anyCellsUpdated = false;
+
+	// Only units changed since this last ran can turn up anything new
+	uint16_t changed = getChangedUnits(HIDDEN_BOXES, BOX_UNITS);
+	if (changed == 0)
+	{
+		return false;
+	}
+
+	// For Each Box
+	for (uint16_t b = 0; b < BOXES; ++b)
+	{
+		if (((changed >> b) & 0x1) == 0)
+		{
+			continue;
+		}
+
+		// Get the Row of the first box cell
+		uint16_t startRow = BOX_ROW[b];
+
+		// Get the Col of the first box cell
+		uint16_t startCol = BOX_COL[b];
+
+		//  For Each cell in Box
+		for (uint16_t r1 = startRow; r1 < startRow + DIMENSION; ++r1)
+		{
+			for (uint16_t c1 = startCol; c1 < startCol + DIMENSION; ++c1)
+			{
+				uint16_t idx1 = getIndex(r1, c1);
+
+				++numReads;
+				uint16_t cell1 = grid[idx1];
+
+				// Check if this cell has 2 possibilities left
+				if (popCount(cell1) != 2)
+				{
+					continue;
+				}
+
+				//  For Each other cell in Box
+				for (uint16_t r2 = startRow; r2 < startRow + DIMENSION; ++r2)
+				{
+					for (uint16_t c2 = startCol; c2 < startCol + DIMENSION; ++c2)
+					{
+						uint16_t idx2 = getIndex(r2, c2);
+
+						// Skip the identical cells
+						if (idx1 == idx2)
+						{
+							continue;
+						}
+
+						++numReads;
+						uint16_t cell2 = grid[idx2];
+
+						// If 2 different cells with a pop count of 2 exist, then we found a hidden pair
+						if (cell1 == cell2)
+						{
+							// For every other cell in the box, remove these 2 numbers as possibilities
+							for (uint16_t r3 = startRow; r3 < startRow + DIMENSION; ++r3)
+							{
+								for (uint16_t c3 = startCol; c3 < startCol + DIMENSION; ++c3)
+								{
+									uint16_t idx3 = getIndex(r3, c3);
+
+									if (idx3 != idx1 &&
+										idx3 != idx2)
+									{
+										++numReads;
+										uint16_t cell3 = grid[idx3];
+
+										// Skip solved cells
+										if ((cell3 & SOLVED) == 0 &&
+											(cell3 & cell1) != 0)
+										{
+											setCell(idx3, grid[idx3] & ~cell1);
+											++numWrites;
+
+											anyCellsUpdated = true;
+										}
+									}
+								}
+							}
+						} // End if cell1 == cell 2
+					}
+				} // End For every other cell
+			}
+		} // End for every cell
+	} // End for every Box
+
+	return anyCellsUpdated;
+}
+
+bool checkHiddenRows()
+{
+	bool anyCellsUpdated = false;
+
+	// Only units changed since this last ran can turn up anything new
+	uint16_t changed = getChangedUnits(HIDDEN_ROWS, ROW_UNITS);
+	if (changed == 0)
+	{
+		return false;
+	}
+
+	// For Every Row
+	for (uint16_t r = 0; r < ROWS; ++r)
+	{
+		if (((changed >> r) & 0x1) == 0)
+		{
+			continue;
+		}
+
+		// For Every cell in row
+		for (uint16_t c1 = 0; c1 < COLS; ++c1)
+		{
+			uint16_t idx1 = getIndex(r, c1);
+
+			++numReads;
+			uint16_t cell1 = grid[idx1];
+
+			// Check if this cell has 2 possibilities left
+			if (popCount(cell1) != 2)
+			{
+				continue;
+			}
+
+			// For every other cell in row
+			for (uint16_t c2 = c1 + 1; c2 < COLS; ++c2)
+			{
+				uint16_t idx2 = getIndex(r, c2);
+
+				++numReads;
+				uint16_t cell2 = grid[idx2];
+
+				// If 2 different cells with a pop count of 2 exist, then we found a hidden pair
+				if (cell1 == cell2)
+				{
+					// For every other cell in the row, remove these 2 numbers as possibilities
+					for (uint16_t c3 = 0; c3 < COLS; ++c3)
+					{
+						uint16_t idx3 = getIndex(r, c3);
+
+						if (idx3 != idx1 &&
+							idx3 != idx2)
+						{
+							++numReads;
+							uint16_t cell3 = grid[idx3];
+
+							// Skip solved cells
+							if ((cell3 & SOLVED) == 0 &&
+								(cell3 & cell1) != 0)
+							{
+								setCell(idx3, grid[idx3] & ~cell1);
+								++numWrites;
+
+								anyCellsUpdated = true;
+							}
+						}
+					} // End for every other other cell
+				} // End if Cell1 == Cell 2
+			} // End for every other cell
+		} // End for every cell
+	} // End for every row
+
+	return anyCellsUpdated;
+}
+
+bool checkHiddenCols()
+{
+	bool anyCellsUpdated = false;
+
+	// Only units changed since this last ran can turn up anything new
+	uint16_t changed = getChangedUnits(HIDDEN_COLS, COL_UNITS);
+	if (changed == 0)
+	{
+		return false;
+	}
+
+	// For Every Col
+	for (uint16_t c = 0; c < COLS; ++c)
+	{
+		if (((changed >> c) & 0x1) == 0)
+		{
+			continue;
+		}
+
+		// For Every cell in col
+		for (uint16_t r1 = 0; r1 < ROWS; ++r1)
+		{
+			uint16_t idx1 = getIndex(r1, c);
+
+			++numReads;
+			uint16_t cell1 = grid[idx1];
+
+			// Check if this cell has 2 possibilities left
+			if (popCount(cell1) != 2)
+			{
+				continue;
+			}
+
+			// For every other cell in col
+			for (uint16_t r2 = r1 + 1; r2 < ROWS; ++r2)
+			{
+				uint16_t idx2 = getIndex(r2, c);
+
+				++numReads;
+				uint16_t cell2 = grid[idx2];
+
+				// If 2 different cells with a pop count of 2 exist, then we found a hidden pair
+				if (cell1 == cell2)
+				{
+					// For every other cell in the col, remove these 2 numbers as possibilities
+					for (uint16_t r3 = 0; r3 < ROWS; ++r3)
+					{
+						uint16_t idx3 = getIndex(r3, c);
+
+						if (idx3 != idx1 &&
+							idx3 != idx2)
+						{
+							++numReads;
+							uint16_t cell3 = grid[idx3];
+
+							// Skip solved cells
+							if ((cell3 & SOLVED) == 0 &&
+								(cell3 & cell1) != 0)
+							{
+								setCell(idx3, grid[idx3] & ~cell1);
+								++numWrites;
+
+								anyCellsUpdated = true;
+							}
+						}
+					} // End for every other other cell
+				} // End if Cell1 == Cell 2
+			} // End for every other cell
+		} // End for every cell
+	} // End for every Col
+
+	return anyCellsUpdated;
+}
+
+// Check for hidden pairs, with all possible pairs 
+bool checkHiddenBoxesV2()
+{
+	bool anyCellsUpdated = false;
+
+	// Only units changed since this last ran can turn up anything new
+	uint16_t changed = getChangedUnits(HIDDEN_BOXES_V2, BOX_UNITS);
+	if (changed == 0)
+	{
+		return false;
+	}
+
+	// For every pair of values
+	for (int val1 = 1; val1 < 10; ++val1)
+	{
+		for (int val2 = val1 + 1; val2 < 10; ++val2)
+		{
+			uint16_t valuePair = NUMBERS[val1] | NUMBERS[val2];
+
+			// For Each Box
+			for (uint16_t b = 0; b < BOXES; ++b)
+			{
+				if (((changed >> b) & 0x1) == 0)
+				{
+					continue;
+				}
+
+				// Get the Row of the first box cell
+				uint16_t startRow = BOX_ROW[b];
+
+				// Get the Col of the first box cell
+				uint16_t startCol = BOX_COL[b];
+
+				//  For Each cell in Box
+				for (uint16_t r1 = startRow; r1 < startRow + DIMENSION; ++r1)
+				{
+					for (uint16_t c1 = startCol; c1 < startCol + DIMENSION; ++c1)
+					{
+						uint16_t idx1 = getIndex(r1, c1);
+
+						++numReads;
+						uint16_t cell1 = grid[idx1];
+
+						// Check if cell1 matches the value pair
+						if ((cell1 & valuePair) != valuePair ||
+							(cell1 & SOLVED) == SOLVED)
+						{
+							continue;
+						}
+
+						//  For Each other cell in Box
+						for (uint16_t r2 = startRow; r2 < startRow + DIMENSION; ++r2)
+						{
+							for (uint16_t c2 = startCol; c2 < startCol + DIMENSION; ++c2)
+							{
+
+								uint16_t idx2 = getIndex(r2, c2);
+
+								++numReads;
+								uint16_t cell2 = grid[idx2];
+
+								// Check if cell 2 matches the value pair
+								if ((cell2 & valuePair) != valuePair ||
+									(cell2 & SOLVED) == SOLVED)
+								{
+									continue;
+								}
+
+								bool pairFound = true;
+
+								for (uint16_t r3 = startRow; r3 < startRow + DIMENSION; ++r3)
+								{
+									for (uint16_t c3 = startCol; c3 < startCol + DIMENSION; ++c3)
+									{
+										uint16_t idx3 = getIndex(r3, c3);
+
+										if (idx3 == idx1 ||
+											idx3 == idx2)
+										{
+											continue;
+										}
+
+										++numReads;
+										uint16_t cell3 = grid[idx3];
+
+										// Check if cell 3 matches either of the value pair
+										if (((cell3 & NUMBERS[val1]) == NUMBERS[val1] ||
+											(cell3 & NUMBERS[val2]) == NUMBERS[val2]) &&
+											(cell3 & SOLVED) != SOLVED)
+										{
+											pairFound = false;
+											break;
+										}
+									}
+									if (!pairFound)
+									{
+										break;
+									}
+								} // End Cell 3
+
+								// If a hidden pair is found, remove these 2 values from all other squares in the box
+								// And mark the 2 paired cells as only possible for the value pair
+								if (pairFound)
+								{
+									if (cell1 != valuePair ||
+										cell2 != valuePair)
+									{
+										setCell(idx1, valuePair);
+										++numWrites;
+										setCell(idx2, valuePair);
+										++numWrites;
+
+										anyCellsUpdated = true;
+									}
+
+									for (uint16_t r4 = startRow; r4 < startRow + DIMENSION; ++r4)
+									{
+										for (uint16_t c4 = startCol; c4 < startCol + DIMENSION; ++c4)
+										{
+											uint16_t idx4 = getIndex(r4, c4);
+
+											if (idx4 == idx1 ||
+												idx4 == idx2)
+											{
+												continue;
+											}
+
+											++numReads;
+											uint16_t cell4 = grid[idx4];
+
+											// Only update unsolved cells
+											if ((cell4 & SOLVED) != SOLVED &&
+												((cell4 & NUMBERS[val1]) == NUMBERS[val1] ||
+													(cell4 & NUMBERS[val2]) == NUMBERS[val2]))
+											{
+												setCell(idx4, grid[idx4] & ~NUMBERS[val1]);
+												++numWrites;
+
+												setCell(idx4, grid[idx4] & ~NUMBERS[val2]);
+												++numWrites;
+
+												anyCellsUpdated = true;
+											}
+										}
+									} // End Cell 4
+								} // End if pair found
+							}
+						} // End Cell 2
+					}
+				} // End Cell 1
+			} // End for each box
+		}
+	} // End for every value pair
+
+	return anyCellsUpdated;
+}
+
+bool checkHiddenRowsV2()
+{
+	bool anyCellsUpdated = false;
+
+	// Only units changed since this last ran can turn up anything new
+	uint16_t changed = getChangedUnits(HIDDEN_ROWS_V2, ROW_UNITS);
+	if (changed == 0)
+	{
+		return false;
+	}
+
+	// For every pair of values
+	for (int val1 = 1; val1 < 10; ++val1)
+	{
+		for (int val2 = val1 + 1; val2 < 10; ++val2)
+		{
+			uint16_t valuePair = NUMBERS[val1] | NUMBERS[val2];
+
+			// For Every Row
+			for (uint16_t r = 0; r < ROWS; ++r)
+			{
+				if (((changed >> r) & 0x1) == 0)
+				{
+					continue;
+				}
+
+				// For Every cell in row
+				for (uint16_t c1 = 0; c1 < COLS; ++c1)
+				{
+					uint16_t idx1 = getIndex(r, c1);
+
+					++numReads;
+					uint16_t cell1 = grid[idx1];
+					
+					// Check if cell1 matches the value pair
+					if ((cell1 & valuePair) != valuePair ||
+						(cell1 & SOLVED) == SOLVED)
+					{
+						continue;
+					}
+
+					// For every other cell in row
+					for (uint16_t c2 = c1 + 1; c2 < COLS; ++c2)
+					{
+						uint16_t idx2 = getIndex(r, c2);
+
+						++numReads;
+						uint16_t cell2 = grid[idx2];
+
+						// Check if cell 2 matches the value pair
+						if ((cell2 & valuePair) != valuePair ||
+							(cell2 & SOLVED) == SOLVED)
+						{
+							continue;
+						}
+
+						bool pairFound = true;
+
+						// Check if any other cell matches either of the value pair
+						for (uint16_t c3 = 0; c3 < COLS; ++c3)
+						{
+							uint16_t idx3 = getIndex(r, c3);
+
+							if (idx3 == idx1 ||
+								idx3 == idx2)
+							{
+								continue;
+							}
+
+							++numReads;
+							uint16_t cell3 = grid[idx3];
+
+							// Check if cell 3 matches either of the value pair
+							if (((cell3 & NUMBERS[val1]) == NUMBERS[val1] ||
+								(cell3 & NUMBERS[val2]) == NUMBERS[val2]) &&
+								(cell3 & SOLVED) != SOLVED)
+							{
+								pairFound = false;
+								break;
+							}
+						}
+
+						// If a hidden pair is found, remove these 2 values from all other squares in the row
+						// And mark the 2 paired cells as only possible for the value pair
+						if (pairFound)
+						{
+							if (cell1 != valuePair ||
+								cell2 != valuePair)
+							{
+								setCell(idx1, valuePair);
+								++numWrites;
+								setCell(idx2, valuePair);
+								++numWrites;
+
+								anyCellsUpdated = true;
+							}
+
+							for (uint16_t c4 = 0; c4 < COLS; ++c4)
+							{
+								uint16_t idx4 = getIndex(r, c4);
+
+								if (idx4 == idx1 ||
+									idx4 == idx2)
+								{
+									continue;
+								}
+
+								++numReads;
+								uint16_t cell4 = grid[idx4];
+
+								// Only update unsolved cells
+								if ((cell4 & SOLVED) != SOLVED &&
+									((cell4 & NUMBERS[val1]) == NUMBERS[val1] ||
+									 (cell4 & NUMBERS[val2]) == NUMBERS[val2]))
+								{
+									setCell(idx4, grid[idx4] & ~NUMBERS[val1]);
+									++numWrites;
+
+									setCell(idx4, grid[idx4] & ~NUMBERS[val2]);
+									++numWrites;
+
+									anyCellsUpdated = true;
+								}
+							}
+						} // End if pair found
+					} // End for every other cell
+				} // End for every cell in row
+			} // End for every row
+		}
+	} // End for every value pair
+
+	return anyCellsUpdated;
+}
+
+bool checkHiddenColsV2()
+{
+	bool anyCellsUpdated = false;
+
+	// Only units changed since this last ran can turn up anything new
+	uint16_t changed = getChangedUnits(HIDDEN_COLS_V2, COL_UNITS);
+	if (changed == 0)
+	{
+		return false;
+	}
+
+	// For every pair of values
+	for (int val1 = 1; val1 < 10; ++val1)
+	{
+		for (int val2 = val1 + 1; val2 < 10; ++val2)
+		{
+			uint16_t valuePair = NUMBERS[val1] | NUMBERS[val2];
+
+			// For Every Col
+			for (uint16_t c = 0; c < COLS; ++c)
+			{
+				if (((changed >> c) & 0x1) == 0)
+				{
+					continue;
+				}
+
+				// For Every cell in col
+				for (uint16_t r1 = 0; r1 < ROWS; ++r1)
+				{
+					uint16_t idx1 = getIndex(r1, c);
+
+					++numReads;
+					uint16_t cell1 = grid[idx1];
+
+					// Check if cell1 matches the value pair
+					if ((cell1 & valuePair) != valuePair ||
+						(cell1 & SOLVED) == SOLVED)
+					{
+						continue;
+					}
+
+					// For every other cell in col
+					for (uint16_t r2 = r1 + 1; r2 < ROWS; ++r2)
+					{
+						uint16_t idx2 = getIndex(r2, c);
+
+						++numReads;
+						uint16_t cell2 = grid[idx2];
+
+						// Check if cell 2 matches the value pair
+						if ((cell2 & valuePair) != valuePair ||
+							(cell2 & SOLVED) == SOLVED)
+						{
+							continue;
+						}
+
+						bool pairFound = true;
+
+						// Check if any other cell matches either of the value pair
+						for (uint16_t r3 = 0; r3 < ROWS; ++r3)
+						{
+							uint16_t idx3 = getIndex(r3, c);
+
+							if (idx3 == idx1 ||
+								idx3 == idx2)
+							{
+								continue;
+							}
+
+							++numReads;
+							uint16_t cell3 = grid[idx3];
+
+							// Check if cell 3 matches either of the value pair
+							if (((cell3 & NUMBERS[val1]) == NUMBERS[val1] ||
+								(cell3 & NUMBERS[val2]) == NUMBERS[val2]) &&
+								(cell3 & SOLVED) != SOLVED)
+							{
+								pairFound = false;
+								break;
+							}
+						}
+
+						// If a hidden pair is found, remove these 2 values from all other squares in the col
+						// And mark the 2 paired cells as only possible for the value pair
+						if (pairFound)
+						{
+							if (cell1 != valuePair ||
+								cell2 != valuePair)
+							{
+								setCell(idx1, valuePair);
+								++numWrites;
+								setCell(idx2, valuePair);
+								++numWrites;
+
+								anyCellsUpdated = true;
+							}
+
+							for (uint16_t r4 = 0; r4 < ROWS; ++r4)
+							{
+								uint16_t idx4 = getIndex(r4, c);
+
+								if (idx4 == idx1 ||
+									idx4 == idx2)
+								{
+									continue;
+								}
+
+								++numReads;
+								uint16_t cell4 = grid[idx4];
+
+								// Only update unsolved cells
+								if ((cell4 & SOLVED) != SOLVED &&
+									((cell4 & NUMBERS[val1]) == NUMBERS[val1] ||
+										(cell4 & NUMBERS[val2]) == NUMBERS[val2]))
+								{
+									setCell(idx4, grid[idx4] & ~NUMBERS[val1]);
+									++numWrites;
+
+									setCell(idx4, grid[idx4] & ~NUMBERS[val2]);
+									++numWrites;
+
+									anyCellsUpdated = true;
+								}
+							}
+						} // End if pair found
+					} // End for every other cell
+				} // End for every cell in col
+			} // End for every col
+		}
+	} // End for every value pair
+
+	return anyCellsUpdated;
+}
+
+// Where each value can still go, as columns along each row and rows along each column
+struct FishLines
+{
+	uint16_t rows[10][ROWS];
+	uint16_t cols[10][COLS];
+};
+
+// Fill in the positions of every value in one pass over the grid
+static void getFishLines(FishLines& lines)
+{
+	for (uint16_t val = 1; val < 10; ++val)
+	{
+		for (uint16_t line = 0; line < ROWS; ++line)
+		{
+			lines.rows[val][line] = 0;
+			lines.cols[val][line] = 0;
+		}
+	}
+
+	for (uint16_t idx = 0; idx < NUM_CELLS; ++idx)
+	{
+		++numReads;
+		uint16_t gridValue = grid[idx];
+		if ((gridValue & SOLVED) == SOLVED)
+		{
+			continue;
+		}
+
+		uint16_t row = ROW_INDEX[idx];
+		uint16_t col = COL_INDEX[idx];
+		for (uint16_t val = 1; val < 10; ++val)
+		{
+			if ((gridValue & NUMBERS[val]) == NUMBERS[val])
+			{
+				lines.rows[val][row] |= 1 << col;
+				lines.cols[val][col] |= 1 << row;
+			}
+		}
+	}
+}
+
+// Remove a value from the cover positions of every line outside the base of a fish
+static bool removeFish(uint16_t val, bool byCol, uint16_t baseLines, uint16_t coverPositions)
+{
+	bool anyCellsUpdated = false;
+
+	for (uint16_t line = 0; line < ROWS; ++line)
+	{
+		// Skip over the base lines
+		if ((baseLines >> line) & 0x1)
+		{
+			continue;
+		}
+
+		for (uint16_t pos = 0; pos < COLS; ++pos)
+		{
+			if (((coverPositions >> pos) & 0x1) == 0)
+			{
+				continue;
+			}
+
+			uint16_t idx = byCol ? getIndex(pos, line) : getIndex(line, pos);
+
+			// Only update un-solved cells
+			++numReads;
+			uint16_t gridValue = grid[idx];
+			if ((gridValue & SOLVED) == 0 &&
+				(gridValue & NUMBERS[val]) == NUMBERS[val])
+			{
+				// Bitwise AND with the ones compiment of the value to switch off only that bit
+				setCell(idx, grid[idx] & ~(NUMBERS[val]));
+				++numWrites;
+				anyCellsUpdated = true;
+
+				// Check if there is now only one possible value for this cell
+				checkCell(idx);
+			}
+		}
+	}
+
+	return anyCellsUpdated;
+}
+
+// Pick base lines from first onwards until there are size of them with their positions
+// all inside size cover positions, then remove the value from the rest of the cover
+static bool findFish(uint16_t val, bool byCol, const uint16_t* lines, uint16_t size,
+	uint16_t first, uint16_t count, uint16_t baseLines, uint16_t coverPositions)
+{
+	if (count == size)
+	{
+		return removeFish(val, byCol, baseLines, coverPositions);
+	}
+
+	for (uint16_t line = first; line < ROWS; ++line)
+	{
+		// Lines with a single position are left to the singles, and solved lines have none
+		uint16_t positions = popCount(lines[line]);
+		if (positions < 2 || positions > size)
+		{
+			continue;
+		}
+
+		uint16_t cover = coverPositions | lines[line];
+		if (popCount(cover) > size)
+		{
+			continue;
+		}
+
+		if (findFish(val, byCol, lines, size, line + 1, count + 1, baseLines | (1 << line), cover))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Check each value for fish of a given size along the rows, then along the columns
+static bool checkFish(uint16_t size)
+{
+	bool anyCellsUpdated = false;
+
+	FishLines lines;
+	getFishLines(lines);
+
+	// For each value, with the lines read again whenever anything is removed
+	for (uint16_t val = 1; val < 10; ++val)
+	{
+		while (findFish(val, false, lines.rows[val], size, 0, 0, 0, 0))
+		{
+			anyCellsUpdated = true;
+			getFishLines(lines);
+		}
+
+		while (findFish(val, true, lines.cols[val], size, 0, 0, 0, 0))
+		{
+			anyCellsUpdated = true;
+			getFishLines(lines);
+		}
+	}
+
+	return anyCellsUpdated;
+}
+
+bool checkXWings()
+{
+	return checkFish(2);
+}
+
+bool checkSwordfish()
+{
+	return checkFish(3);
+}
+
+bool checkJellyfish()
+{
+	return checkFish(4);
+}
+
+// Check whether two different cells share a row, column or box
+static bool isPeer(uint16_t idx1, uint16_t idx2)
+{
+	return idx1 != idx2 &&
+		(ROW_INDEX[idx1] == ROW_INDEX[idx2] ||
+		 COL_INDEX[idx1] == COL_INDEX[idx2] ||
+		 BOX_INDEX[idx1] == BOX_INDEX[idx2]);
+}
+
+// Cells sharing a row, column or box with each cell
+static const uint16_t NUM_PEERS = 20;
+
+struct PeerTable
+{
+	uint16_t peers[NUM_CELLS][NUM_PEERS];
+
+	PeerTable()
+	{
+		for (uint16_t idx1 = 0; idx1 < NUM_CELLS; ++idx1)
+		{
+			uint16_t count = 0;
+			for (uint16_t idx2 = 0; idx2 < NUM_CELLS; ++idx2)
+			{
+				if (isPeer(idx1, idx2))
+				{
+					peers[idx1][count++] = idx2;
+				}
+			}
+		}
+	}
+};
+
+static const PeerTable PEERS;
+
+// Remove a value from every cell that sees both pincers of a wing, and the pivot as well if needed
+static bool removeWing(uint16_t value, uint16_t pivot, uint16_t pincer1, uint16_t pincer2, bool seesPivot)
+{
+	bool anyCellsUpdated = false;
+
+	for (uint16_t i = 0; i < NUM_PEERS; ++i)
+	{
+		uint16_t idx = PEERS.peers[pincer1][i];
+		if (idx == pivot || !isPeer(idx, pincer2) || (seesPivot && !isPeer(idx, pivot)))
+		{
+			continue;
+		}
+
+		// Only update un-solved cells
+		++numReads;
+		uint16_t gridValue = grid[idx];
+		if ((gridValue & SOLVED) == 0 &&
+			(gridValue & value) == value)
+		{
+			setCell(idx, grid[idx] & ~value);
+			++numWrites;
+			anyCellsUpdated = true;
+
+			// Check if there is now only one possible value for this cell
+			checkCell(idx);
+		}
+	}
+
+	return anyCellsUpdated;
+}
+
+// Check for wings around pivots with 2 (XY-Wing) or 3 (XYZ-Wing) possibilities. Two
+// pincers seeing the pivot, each with 2 possibilities, share a value z and between
+// them cover the rest of the pivot, so whichever value the pivot takes, one of the
+// pincers (or for XYZ-Wings the pivot itself) is z.
+static bool checkWings(uint16_t pivotCount)
+{
+	bool anyCellsUpdated = false;
+
+	// Pincers share 1 value with an XY-Wing pivot, and are inside an XYZ-Wing pivot
+	uint16_t sharedCount = pivotCount - 1;
+
+	for (uint16_t p = 0; p < NUM_CELLS; ++p)
+	{
+		++numReads;
+		uint16_t pivot = grid[p];
+		if ((pivot & SOLVED) == SOLVED || popCount(pivot) != pivotCount)
+		{
+			continue;
+		}
+
+		// Find every cell seeing the pivot that could be a pincer
+		uint16_t pincers[NUM_PEERS];
+		uint16_t pincerCount = 0;
+		for (uint16_t i = 0; i < NUM_PEERS; ++i)
+		{
+			uint16_t idx = PEERS.peers[p][i];
+
+			++numReads;
+			uint16_t cell = grid[idx];
+			if ((cell & SOLVED) == 0 && popCount(cell) == 2 && popCount(cell & pivot) == sharedCount)
+			{
+				pincers[pincerCount++] = idx;
+			}
+		}
+
+		for (uint16_t i = 0; i < pincerCount; ++i)
+		{
+			for (uint16_t j = i + 1; j < pincerCount; ++j)
+			{
+				// Removals can solve cells, so the pincers are read again each time
+				uint16_t cell1 = grid[pincers[i]];
+				uint16_t cell2 = grid[pincers[j]];
+				uint16_t z = cell1 & cell2;
+				numReads += 2;
+
+				if ((cell1 & SOLVED) == SOLVED || (cell2 & SOLVED) == SOLVED ||
+					popCount(z) != 1 || (cell1 | cell2) != (pivot | z))
+				{
+					continue;
+				}
+
+				if (removeWing(z, p, pincers[i], pincers[j], pivotCount == 3))
+				{
+					anyCellsUpdated = true;
+				}
+			}
+		}
+	}
+
+	return anyCellsUpdated;
+}
+
+bool checkXYWings()
+{
+	return checkWings(2);
+}
+
+bool checkXYZWings()
+{
+	return checkWings(3);
+}
+
+// Check for single value coloring. Units where a value can only go in 2 cells link
+// those cells, and exactly one of each linked pair is the value. Coloring each chain
+// of links in 2 alternating colors, one color is the value throughout the chain:
+// - if 2 cells of the same color see each other, that color is wrong
+// - any other cell that sees both colors can't be the value
+bool checkColoring()
+{
+	bool anyCellsUpdated = false;
+
+	// For each value
+	for (uint16_t val = 1; val < 10; ++val)
+	{
+		// Cells that can still be the value
+		uint16_t candidates[NUM_CELLS];
+		uint16_t candidateCount = 0;
+		for (uint16_t idx = 0; idx < NUM_CELLS; ++idx)
+		{
+			++numReads;
+			uint16_t gridValue = grid[idx];
+			if ((gridValue & SOLVED) == 0 &&
+				(gridValue & NUMBERS[val]) == NUMBERS[val])
+			{
+				candidates[candidateCount++] = idx;
+			}
+		}
+
+		// Count the places for the value in each unit: rows, then columns, then boxes
+		uint16_t unitCount[ROWS + COLS + BOXES] = { 0 };
+		uint16_t unitCells[ROWS + COLS + BOXES][2];
+		for (uint16_t i = 0; i < candidateCount; ++i)
+		{
+			uint16_t idx = candidates[i];
+			uint16_t units[3] = { ROW_INDEX[idx], (uint16_t)(ROWS + COL_INDEX[idx]), (uint16_t)(ROWS + COLS + BOX_INDEX[idx]) };
+
+			for (uint16_t u = 0; u < 3; ++u)
+			{
+				uint16_t& count = unitCount[units[u]];
+				if (count < 2)
+				{
+					unitCells[units[u]][count] = idx;
+				}
+				++count;
+			}
+		}
+
+		// The pairs of cells that are the only places for the value in a unit
+		uint16_t links[ROWS + COLS + BOXES][2];
+		uint16_t linkCount = 0;
+		for (uint16_t unit = 0; unit < ROWS + COLS + BOXES; ++unit)
+		{
+			if (unitCount[unit] == 2)
+			{
+				links[linkCount][0] = unitCells[unit][0];
+				links[linkCount][1] = unitCells[unit][1];
+				++linkCount;
+			}
+		}
+
+		// Chain number of each cell, 0 for none, and its color
+		uint16_t chain[NUM_CELLS] = { 0 };
+		uint16_t color[NUM_CELLS];
+		uint16_t chainCount = 0;
+
+		for (uint16_t l = 0; l < linkCount; ++l)
+		{
+			if (chain[links[l][0]] != 0)
+			{
+				continue;
+			}
+
+			// Color a new chain, following the links out from each cell reached
+			uint16_t chainCells[NUM_CELLS];
+			uint16_t chainSize = 0;
+			++chainCount;
+			chain[links[l][0]] = chainCount;
+			color[links[l][0]] = 0;
+			chainCells[chainSize++] = links[l][0];
+
+			for (uint16_t next = 0; next < chainSize; ++next)
+			{
+				uint16_t idx = chainCells[next];
+				for (uint16_t k = 0; k < linkCount; ++k)
+				{
+					for (uint16_t end = 0; end < 2; ++end)
+					{
+						uint16_t other = links[k][1 - end];
+						if (links[k][end] == idx && chain[other] == 0)
+						{
+							chain[other] = chainCount;
+							color[other] = 1 - color[idx];
+							chainCells[chainSize++] = other;
+						}
+					}
+				}
+			}
+
+			// Check for 2 cells of the same color seeing each other
+			bool wrong[2] = { false, false };
+			for (uint16_t i = 0; i < chainSize; ++i)
+			{
+				for (uint16_t j = i + 1; j < chainSize; ++j)
+				{
+					if (color[chainCells[i]] == color[chainCells[j]] && isPeer(chainCells[i], chainCells[j]))
+					{
+						wrong[color[chainCells[i]]] = true;
+					}
+				}
+			}
+
+			for (uint16_t i = 0; i < candidateCount; ++i)
+			{
+				uint16_t idx = candidates[i];
+				bool remove = false;
+
+				if (chain[idx] == chainCount)
+				{
+					remove = wrong[color[idx]];
+				}
+				else
+				{
+					// Check for a cell seeing both colors
+					bool sees[2] = { false, false };
+					for (uint16_t j = 0; j < chainSize; ++j)
+					{
+						if (isPeer(idx, chainCells[j]))
+						{
+							sees[color[chainCells[j]]] = true;
+						}
+					}
+
+					remove = sees[0] && sees[1];
+				}
+
+				// Only update cells that are still un-solved
+				++numReads;
+				uint16_t gridValue = grid[idx];
+				if (remove &&
+					(gridValue & SOLVED) == 0 &&
+					(gridValue & NUMBERS[val]) == NUMBERS[val])
+				{
+					// Bitwise AND with the ones compiment of the value to switch off only that bit
+					setCell(idx, grid[idx] & ~(NUMBERS[val]));
+					++numWrites;
+					anyCellsUpdated = true;
+
+					// Check if there is now only one possible value for this cell
+					checkCell(idx);
+				}
+			}
+		}
+	}
+
+	return anyCellsUpdated;
+}
+
+// Check for pattern overlays: for each value, overlay every way of placing it once in
+// each row, column and box that fits the grid. Cells no placement covers can't be
+// the value, and a cell every placement covers must be it.
+bool checkPatternOverlay()
+{
+	bool anyCellsUpdated = false;
+
+	// For each value
+	for (uint16_t val = 1; val < 10; ++val)
+	{
+		CellSet allowed = CellSet();
+		CellSet required = CellSet();
+		uint16_t solvedCount = 0;
+
+		for (uint16_t idx = 0; idx < NUM_CELLS; ++idx)
+		{
+			++numReads;
+			uint16_t gridValue = grid[idx];
+
+			if ((gridValue & SOLVED) == SOLVED)
+			{
+				if ((gridValue & ~(SOLVED)) == val)
+				{
+					addCell(allowed, idx);
+					addCell(required, idx);
+					++solvedCount;
+				}
+			}
+			else if ((gridValue & NUMBERS[val]) == NUMBERS[val])
+			{
+				addCell(allowed, idx);
+			}
+		}
+
+		// Skip values already placed everywhere
+		if (solvedCount == ROWS)
+		{
+			continue;
+		}
+
+		CellSet anyCells;
+		CellSet allCells;
+		if (overlayPlacements(allowed, required, anyCells, allCells) == 0)
+		{
+			continue;
+		}
+
+		for (uint16_t idx = 0; idx < NUM_CELLS; ++idx)
+		{
+			if (!hasCell(allowed, idx) || hasCell(required, idx))
+			{
+				continue;
+			}
+
+			// Only update cells that are still un-solved
+			++numReads;
+			uint16_t gridValue = grid[idx];
+			if ((gridValue & SOLVED) == SOLVED ||
+				(gridValue & NUMBERS[val]) != NUMBERS[val])
+			{
+				continue;
+			}
+
+			if (hasCell(allCells, idx))
+			{
+				updateCell(idx, val);
+				anyCellsUpdated = true;
+			}
+			else if (!hasCell(anyCells, idx))
+			{
+				// Bitwise AND with the ones compiment of the value to switch off only that bit
+				setCell(idx, grid[idx] & ~(NUMBERS[val]));
+				++numWrites;
+				anyCellsUpdated = true;
+
+				// Check if there is now only one possible value for this cell
+				checkCell(idx);
+			}
+		}
+	}
+
+	return anyCellsUpdated;
+}
+
+// Print the grid
+void printGrid(bool debug)
+{
+	if (!isOutputEnabled())
+	{
+		return;
+	}
+
+	OutputBuffer& out = getOutputBuffer();
+	uint16_t MAX_WIDTH = 2;
+
+	if (debug) MAX_WIDTH = 4;
+
+	out.put('\n');
+
+	for (uint16_t r = 0; r < ROWS; ++r)
+	{
+		if (r % DIMENSION == 0 && r != 0)
+		{
+
+			for (uint16_t i = 0; i < (ROWS * MAX_WIDTH) + ROWS + DIMENSION; ++i)
+			{
+				out.put('-');
+			}
+
+			out.put('\n');
+		}
+
+		for (uint16_t c = 0; c < COLS; ++c)
+		{
+			if (c % DIMENSION == 0 && c != 0)
+			{
+				out.put('|');
+			}
+
+			uint16_t idx = getIndex(r, c);
+			// Only update un-solved cells
+			if ((grid[idx] & SOLVED) == 0)
+			{
+				printCell(out, grid[idx], debug);
+			}
+			else
+			{
+				printSolvedCell(out, grid[idx], debug);
+			}
+		}
+
+
+		out.put('\n');
+	}
+	out.put('\n');
+
+	// Write the whole board at once
+	out.flush();
+}
+
+void printCell(OutputBuffer& out, uint16_t cellValue, bool debug)
+{
+	if (debug)
+	{
+		out.putNumber(cellValue, 4, '-');
+		out.put(' ');
+	}
+	else out.put("   ", 3);
+}
+
+void printSolvedCell(OutputBuffer& out, uint16_t cellValue, bool debug)
+{
+	out.putNumber(cellValue & ~(SOLVED), debug ? 4 : 2);
+	out.put(' ');
+}
+
+// 16-bit Hamming Weight
+// https://stackoverflow.com/questions/9946115/hamming-weight-written-only-in-binary-operations
+uint16_t popCount(uint16_t n)
+{
+	// each bit in n is a one-bit integer that indicates how many bits are set
+	// in that bit.
+
+	n = ((n & 0xAAAAAAAA) >> 1) + (n & 0x55555555);
+
+	// Now every two bits are a two bit integer that indicate how many bits were
+	// set in those two bits in the original number
+
+	n = ((n & 0xCCCCCCCC) >> 2) + (n & 0x33333333);
+	// Now we're at 4 bits
+
+	n = ((n & 0xF0F0F0F0) >> 4) + (n & 0x0F0F0F0F);
+	// 8 bits
+
+	n = ((n & 0xFF00FF00) >> 8) + (n & 0x00FF00FF);
+	// 16 bits
+
+	return n;
+}
\ No newline at end of file
@@ -0,0 +1,138 @@
+#ifndef SOLVER_HPP
+#define SOLVER_HPP
+
+#include <atomic>
+#include <iostream>
+#include <stdint.h>
+
+#include "metrics.hpp"
+#include "output.hpp"
+
+const uint16_t DIMENSION = 3;
+
+static const uint16_t ROWS = DIMENSION * DIMENSION;
+static const uint16_t COLS = DIMENSION * DIMENSION;
+static const uint16_t BOXES = DIMENSION * DIMENSION;
+static const uint16_t NUM_CELLS = DIMENSION * DIMENSION * DIMENSION * DIMENSION;
+
+// Each cell is a 16 bit number representing the state of the cell
+// If Bit 16 is set, then the 8 lsbs represent the value of the cell
+// Otherwise, the 10 lsbs represent the posibilites of the cell as a 1-indexed bitmap
+
+// The grid, statistics and technique profiles are kept per thread, so separate
+// threads can each solve their own puzzle
+extern thread_local uint16_t grid[NUM_CELLS];
+
+// Bit-wise constants
+const uint16_t SOLVED = 0x8000;
+
+// Get the number from a cell with only 1 bit set
+uint16_t getNumber(uint16_t cellValue);
+
+// Get a 1D index for a 2D cell
+uint16_t getIndex(uint16_t row, uint16_t col);
+
+// Get the top left index for a given cells box
+uint16_t getBox(uint16_t row, uint16_t col);
+
+// Set a given cell to a given value, and update all possibilities
+void updateCell(uint16_t row, uint16_t col, uint16_t value, bool init = false);
+void updateCell(uint16_t idx, uint16_t value, bool init = false);
+
+void updateRow(uint16_t row, uint16_t col, uint16_t value, bool init = false);
+void updateCol(uint16_t row, uint16_t col, uint16_t value, bool init = false);
+void updateBox(uint16_t row, uint16_t col, uint16_t value, bool init = false);
+
+// Check all Rows/Cols/Boxes for any last possible values
+bool checkCell(uint16_t idx);
+bool checkCells();
+bool checkRows();
+bool checkCols();
+bool checkBoxes();
+
+// Get the index of the last reamining posibility in a row/col for a given value
+uint16_t getLastInRow(uint16_t row, uint16_t value);
+uint16_t getLastInCol(uint16_t col, uint16_t value);
+uint16_t getLastInBox(uint16_t box, uint16_t value);
+
+// Check for Naked Pairs
+bool checkNakedBoxes();
+bool checkNakedRows();
+bool checkNakedCols();
+
+// Check for Hidden pairs - with only 2 possibilities in a square
+bool checkHiddenBoxes();
+bool checkHiddenRows();
+bool checkHiddenCols();
+
+// Check for hidden pairs, with all possible pairs 
+bool checkHiddenBoxesV2();
+bool checkHiddenRowsV2();
+bool checkHiddenColsV2();
+
+// Check for fish - 2, 3 or 4 rows where a value can only go in the same number of
+// columns, so it can be removed from the rest of those columns (and the same for columns)
+bool checkXWings();
+bool checkSwordfish();
+bool checkJellyfish();
+
+// Check for wings - a pivot cell and 2 cells seeing it, with 2 possibilities each, that
+// between them force a value out of every cell seeing both of them
+bool checkXYWings();
+bool checkXYZWings();
+
+// Check for single value chains of cells where the value can only go in one of each linked pair
+bool checkColoring();
+
+// Check for cells that every, or no, placement of a value fitting the grid covers
+bool checkPatternOverlay();
+
+// Print the grid
+void printGrid(bool debug = false);
+
+// Format a cell into the output buffer
+void printCell(OutputBuffer& out, uint16_t cellValue, bool debug);
+void printSolvedCell(OutputBuffer& out, uint16_t cellValue, bool debug);
+
+// 16-bit Hamming Weight
+// https://stackoverflow.com/questions/9946115/hamming-weight-written-only-in-binary-operations
+uint16_t popCount(uint16_t n);
+
+// Statistics
+extern thread_local uint64_t numReads;
+extern thread_local uint64_t numWrites;
+
+// Reorder techniques within each tier by their observed yield before each solve,
+// and skip techniques that have never made progress; set before any solving threads start
+extern std::atomic<bool> adaptiveOrdering;
+
+// Clear the grid and place the givens of a puzzle (1-9, 0 for blanks)
+void loadGrid(const int* board);
+void loadGrid(const uint8_t* digits);
+
+// Run the solving techniques until none of them can make any progress, or the limits are reached
+void solveGrid();
+
+// Cut each later solve on this thread short after maxSteps technique runs or
+// maxMicroseconds, whichever comes first. 0 means no limit.
+void setSolveLimits(uint64_t maxSteps, uint64_t maxMicroseconds);
+
+// Check whether the last solve was cut short by the limits
+bool isSolveLimitExceeded();
+
+// Get the number of technique runs the last solve took, as counted against the step limit
+uint64_t getSolveSteps();
+
+// Check that every cell of the grid has been solved
+bool isGridSolved();
+
+// Copy the grid out as 81 digits, with 0 for cells not yet solved
+void getGridDigits(uint8_t* digits);
+
+// Print where time was spent over every solve so far on this thread
+void printTechniqueReport(std::ostream& out);
+
+// Fill in the technique statistics of a metrics record from the last solve
+void getTechniqueMetrics(SolveMetrics& metrics);
+
+#endif
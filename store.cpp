@@ -0,0 +1,323 @@
+#include "store.hpp"
+
+#include <atomic>
+#include <string.h>
+
+#include "sudoku.h"
+
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/file.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+static const char STORE_MAGIC[4] = { 'S', 'D', 'K', 'S' };
+static const uint32_t STORE_VERSION = 1;
+
+// Slot states. An entry stored before its puzzle was graded is ready but may
+// still be rewritten once with a grade, graded entries never change again.
+static const uint32_t SLOT_EMPTY = 0;
+static const uint32_t SLOT_WRITING = 1;
+static const uint32_t SLOT_READY = 2;
+static const uint32_t SLOT_GRADED = 3;
+
+// Keep one slot in this many free, so probes stay short
+static const uint64_t FREE_SLOT_RATIO = 10;
+
+// The state and count are shared between processes through the mapping, so they
+// must be plain lock free words
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "slot states must be lock free");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "entry counts must be lock free");
+
+struct SolutionStore::Header
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t slotSize;
+	uint32_t reserved;
+	uint64_t capacity;
+	std::atomic<uint64_t> count;
+	uint8_t padding[32];
+};
+
+struct SolutionStore::Slot
+{
+	std::atomic<uint32_t> state;
+	uint8_t status;
+	uint8_t difficulty;
+	uint16_t reserved;
+	uint64_t hash;
+	uint8_t key[CACHE_KEY_SIZE];
+
+	// The solution packed like the key, two cells to a byte
+	uint8_t solution[CACHE_KEY_SIZE];
+	uint16_t counts[STORE_COUNTS];
+	uint8_t padding[12];
+};
+
+SolutionStore::SolutionStore() :
+	header(NULL),
+	slots(NULL),
+	mappingSize(0)
+{
+	static_assert(sizeof(Header) == 64, "store header layout changed");
+	static_assert(sizeof(Slot) == 128, "store slot layout changed");
+}
+
+SolutionStore::~SolutionStore()
+{
+	close();
+}
+
+bool SolutionStore::isOpen() const
+{
+	return header != NULL;
+}
+
+uint64_t SolutionStore::getCount() const
+{
+	return (header == NULL) ? 0 : header->count.load(std::memory_order_relaxed);
+}
+
+uint64_t SolutionStore::getCapacity() const
+{
+	return (header == NULL) ? 0 : header->capacity;
+}
+
+#ifdef _WIN32
+
+bool SolutionStore::open(const char*, uint64_t)
+{
+	close();
+	return false;
+}
+
+void SolutionStore::close()
+{
+}
+
+#else
+
+bool SolutionStore::open(const char* path, uint64_t capacity)
+{
+	close();
+
+	int file = ::open(path, O_RDWR | O_CREAT, 0666);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	// Only one process at a time may create or check the header
+	if (flock(file, LOCK_EX) != 0)
+	{
+		::close(file);
+		return false;
+	}
+
+	struct stat info;
+	bool ok = fstat(file, &info) == 0;
+	bool create = ok && info.st_size == 0;
+
+	Header existing;
+	uint64_t slotCount = 1;
+	if (create)
+	{
+		while (slotCount < capacity)
+		{
+			slotCount <<= 1;
+		}
+
+		ok = ftruncate(file, (off_t)(sizeof(Header) + slotCount * sizeof(Slot))) == 0;
+	}
+	else if (ok)
+	{
+		ok = (size_t)info.st_size >= sizeof(Header) &&
+			pread(file, &existing, sizeof(existing), 0) == (ssize_t)sizeof(existing) &&
+			memcmp(existing.magic, STORE_MAGIC, sizeof(STORE_MAGIC)) == 0 &&
+			existing.version == STORE_VERSION &&
+			existing.slotSize == sizeof(Slot) &&
+			existing.capacity != 0 &&
+			(existing.capacity & (existing.capacity - 1)) == 0 &&
+			(uint64_t)info.st_size == sizeof(Header) + existing.capacity * sizeof(Slot);
+		slotCount = existing.capacity;
+	}
+
+	void* mapping = MAP_FAILED;
+	size_t size = sizeof(Header) + slotCount * sizeof(Slot);
+	if (ok)
+	{
+		mapping = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+	}
+
+	if (mapping != MAP_FAILED && create)
+	{
+		// The new file reads as zeros, so every slot is already empty
+		Header* created = (Header*)mapping;
+		memcpy(created->magic, STORE_MAGIC, sizeof(STORE_MAGIC));
+		created->version = STORE_VERSION;
+		created->slotSize = sizeof(Slot);
+		created->capacity = slotCount;
+		created->count.store(0);
+	}
+
+	flock(file, LOCK_UN);
+
+	// The mapping keeps the file open
+	::close(file);
+
+	if (mapping == MAP_FAILED)
+	{
+		return false;
+	}
+
+	header = (Header*)mapping;
+	slots = (Slot*)((char*)mapping + sizeof(Header));
+	mappingSize = size;
+	return true;
+}
+
+void SolutionStore::close()
+{
+	if (header != NULL)
+	{
+		munmap(header, mappingSize);
+	}
+
+	header = NULL;
+	slots = NULL;
+	mappingSize = 0;
+}
+
+#endif
+
+bool SolutionStore::find(const CacheKey& key, StoredSolution& value) const
+{
+	if (header == NULL)
+	{
+		return false;
+	}
+
+	uint64_t mask = header->capacity - 1;
+	for (uint64_t probe = 0; probe <= mask; ++probe)
+	{
+		const Slot& slot = slots[(key.hash + probe) & mask];
+		uint32_t state = slot.state.load(std::memory_order_acquire);
+		if (state == SLOT_EMPTY)
+		{
+			return false;
+		}
+
+		// Entries still being written are passed over, the caller will just solve the puzzle
+		if ((state != SLOT_READY && state != SLOT_GRADED) || slot.hash != key.hash ||
+			memcmp(slot.key, key.packed, CACHE_KEY_SIZE) != 0)
+		{
+			continue;
+		}
+
+		value.status = slot.status;
+		value.difficulty = slot.difficulty;
+		for (uint16_t i = 0; i + 1 < CACHE_CELLS; i += 2)
+		{
+			value.solution[i] = slot.solution[i / 2] & 0x0F;
+			value.solution[i + 1] = slot.solution[i / 2] >> 4;
+		}
+		value.solution[CACHE_CELLS - 1] = slot.solution[CACHE_CELLS / 2];
+		memcpy(value.counts, slot.counts, sizeof(value.counts));
+
+		// An ungraded entry may have started being rewritten with its grade while it
+		// was copied, in which case the copy may be torn and the entry is passed over
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (state == SLOT_READY && slot.state.load(std::memory_order_relaxed) != SLOT_READY)
+		{
+			continue;
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+// Fill in a slot claimed for writing, then publish it
+void SolutionStore::writeSlot(Slot& slot, const CacheKey& key, const StoredSolution& value)
+{
+	slot.status = value.status;
+	slot.difficulty = value.difficulty;
+	slot.hash = key.hash;
+	memcpy(slot.key, key.packed, CACHE_KEY_SIZE);
+	for (uint16_t i = 0; i + 1 < CACHE_CELLS; i += 2)
+	{
+		slot.solution[i / 2] = (uint8_t)(value.solution[i] | (value.solution[i + 1] << 4));
+	}
+	slot.solution[CACHE_CELLS / 2] = value.solution[CACHE_CELLS - 1];
+	memcpy(slot.counts, value.counts, sizeof(slot.counts));
+
+	uint32_t state = (value.difficulty == SUDOKU_DIFFICULTY_UNKNOWN) ? SLOT_READY : SLOT_GRADED;
+	slot.state.store(state, std::memory_order_release);
+}
+
+// Add an entry unless the key is already there or the store is full, or grade
+// an entry stored without one
+bool SolutionStore::insert(const CacheKey& key, const StoredSolution& value)
+{
+	if (header == NULL)
+	{
+		return false;
+	}
+
+	bool full = header->count.load(std::memory_order_relaxed) >= header->capacity - header->capacity / FREE_SLOT_RATIO;
+
+	uint64_t mask = header->capacity - 1;
+	for (uint64_t probe = 0; probe <= mask; ++probe)
+	{
+		Slot& slot = slots[(key.hash + probe) & mask];
+		uint32_t state = slot.state.load(std::memory_order_acquire);
+
+		// A failed claim leaves state holding whatever another writer put there
+		if (state == SLOT_EMPTY)
+		{
+			if (full)
+			{
+				return false;
+			}
+
+			if (slot.state.compare_exchange_strong(state, SLOT_WRITING, std::memory_order_acquire))
+			{
+				writeSlot(slot, key, value);
+				header->count.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+
+		// Pass over other puzzles and slots still being written. Two processes racing
+		// on the same puzzle may both add it, which only costs a slot.
+		if ((state != SLOT_READY && state != SLOT_GRADED) || slot.hash != key.hash ||
+			memcmp(slot.key, key.packed, CACHE_KEY_SIZE) != 0)
+		{
+			continue;
+		}
+
+		// Grade an entry stored before its puzzle was graded. Should another
+		// process be grading it too, only one of them writes.
+		if (state == SLOT_READY && value.difficulty != SUDOKU_DIFFICULTY_UNKNOWN &&
+			slot.state.compare_exchange_strong(state, SLOT_WRITING, std::memory_order_acquire))
+		{
+			writeSlot(slot, key, value);
+			return true;
+		}
+
+		return false;
+	}
+
+	return false;
+}
+
+// The store shared by the C API and the corpus runner, closed until opened
+SolutionStore& getSolutionStore()
+{
+	static SolutionStore store;
+	return store;
+}
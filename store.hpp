@@ -0,0 +1,84 @@
+#ifndef STORE_HPP
+#define STORE_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "cache.hpp"
+
+// QQWING technique counts kept with each stored solution, in the order of the
+// SolveMetrics fields: givens, singles, hidden singles, naked pairs, hidden
+// pairs, pointing pairs/triples, box/line reductions, guesses, backtracks
+static const uint16_t STORE_COUNTS = 9;
+
+// What is stored about a puzzle
+struct StoredSolution
+{
+	// A sudoku_status from sudoku.h
+	uint8_t status;
+
+	// QQWING difficulty, or 0 (UNKNOWN) if the puzzle has not been graded
+	uint8_t difficulty;
+
+	// 1-9 for every cell when status is SUDOKU_OK
+	uint8_t solution[CACHE_CELLS];
+
+	// All 0 until the puzzle has been graded
+	uint16_t counts[STORE_COUNTS];
+};
+
+// A fixed size open addressing hash table of solutions in a memory mapped file,
+// which any number of processes can read and add to at the same time.
+//
+// Each slot is claimed by atomically moving it from empty to writing, filled
+// in, then published by moving it to ready, so readers only ever see complete
+// entries. Lookups probe linearly from the key's hash until they reach an empty
+// slot. Entries are never removed; once the table is nine tenths full further
+// insertions are refused. A process that dies while writing leaves its slot
+// claimed but never ready, which wastes the slot but harms nothing else.
+//
+// An entry stored without a difficulty is rewritten, once, when its puzzle is
+// graded: it is claimed back from ready to writing and published again as
+// graded. Readers that find it mid rewrite treat it as missing.
+//
+// Only available where POSIX shared mappings are, open() fails elsewhere.
+class SolutionStore
+{
+public:
+	SolutionStore();
+	~SolutionStore();
+
+	SolutionStore(const SolutionStore&) = delete;
+	SolutionStore& operator=(const SolutionStore&) = delete;
+
+	// Open a store, creating it with room for capacity entries (rounded up to a
+	// power of two) if it does not exist. The capacity of an existing store is kept.
+	bool open(const char* path, uint64_t capacity);
+	void close();
+
+	bool isOpen() const;
+
+	bool find(const CacheKey& key, StoredSolution& value) const;
+
+	// Add an entry unless the key is already there or the store is full. An
+	// entry already there without a difficulty is replaced by a graded value.
+	bool insert(const CacheKey& key, const StoredSolution& value);
+
+	uint64_t getCount() const;
+	uint64_t getCapacity() const;
+
+private:
+	struct Header;
+	struct Slot;
+
+	static void writeSlot(Slot& slot, const CacheKey& key, const StoredSolution& value);
+
+	Header* header;
+	Slot* slots;
+	size_t mappingSize;
+};
+
+// The store shared by the C API and the corpus runner, closed until opened
+SolutionStore& getSolutionStore();
+
+#endif
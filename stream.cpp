@@ -0,0 +1,313 @@
+#include "stream.hpp"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+	#include <io.h>
+	#define readInput(buffer, size) _read(0, buffer, (unsigned int)(size))
+#else
+	#include <unistd.h>
+	#define readInput(buffer, size) read(0, buffer, size)
+#endif
+
+#include "canonical.hpp"
+#include "corpus.hpp"
+#include "sudoku.h"
+
+// Bytes asked for from stdin at a time, also the longest line that is kept
+static const size_t STREAM_READ_SIZE = 1 << 16;
+
+// Puzzles held between reading and writing
+static const size_t STREAM_WINDOW = 1024;
+
+// Longest line written per puzzle: puzzle, solution, status and separators
+static const size_t STREAM_MAX_LINE = SUDOKU_CELLS * 2 + 32;
+
+// Marks a window slot whose line could not be read as a puzzle
+static const uint8_t INVALID_CELL = 0xFF;
+
+// Canonical puzzles remembered for deduplication, forgotten all at once when full
+static const size_t STREAM_DEDUPE_ENTRIES = 1 << 16;
+
+// The result of solving a canonical puzzle
+struct CanonicalSolution
+{
+	sudoku_status status;
+	uint8_t solution[SUDOKU_CELLS];
+};
+
+// Puzzles read but not yet solved and written
+struct StreamWindow
+{
+	std::vector<uint8_t> puzzles;
+	std::vector<uint8_t> solutions;
+	std::vector<sudoku_status> statuses;
+	std::vector<char> output;
+	size_t count;
+
+	// Solutions of recent canonical puzzles, when deduplicating
+	bool dedupe;
+	std::unordered_map<std::string, CanonicalSolution> seen;
+};
+
+static const char* getStatusName(sudoku_status status)
+{
+	switch (status)
+	{
+	case SUDOKU_OK:
+		return "solved";
+	case SUDOKU_NO_SOLUTION:
+		return "no solution";
+	case SUDOKU_BUDGET_EXCEEDED:
+		return "budget exceeded";
+	default:
+		return "invalid";
+	}
+}
+
+// Write 81 digits as characters, with '.' for blanks
+static char* writeDigits(char* out, const uint8_t* digits)
+{
+	for (uint16_t i = 0; i < SUDOKU_CELLS; ++i)
+	{
+		out[i] = (digits[i] == 0) ? '.' : (char)('0' + digits[i]);
+	}
+
+	return out + SUDOKU_CELLS;
+}
+
+// Solve each puzzle of the window in its canonical form, reusing the solutions
+// of puzzles seen before
+static void solveDeduplicated(StreamWindow& window)
+{
+	for (size_t p = 0; p < window.count; ++p)
+	{
+		const uint8_t* puzzle = &window.puzzles[p * SUDOKU_CELLS];
+		if (puzzle[0] == INVALID_CELL)
+		{
+			window.statuses[p] = SUDOKU_INVALID_PUZZLE;
+			continue;
+		}
+
+		uint8_t canonical[SUDOKU_CELLS];
+		GridTransform transform;
+		canonicalize(puzzle, canonical, &transform);
+
+		std::string key((const char*)canonical, SUDOKU_CELLS);
+		std::unordered_map<std::string, CanonicalSolution>::iterator found = window.seen.find(key);
+		if (found == window.seen.end())
+		{
+			if (window.seen.size() >= STREAM_DEDUPE_ENTRIES)
+			{
+				window.seen.clear();
+			}
+
+			CanonicalSolution solved;
+			sudoku_solve_records(canonical, SUDOKU_CELLS, solved.solution, SUDOKU_CELLS,
+				SUDOKU_RECORD_DIGITS, &solved.status, 1);
+
+			// A puzzle given up on is tried again when it next turns up
+			if (solved.status == SUDOKU_BUDGET_EXCEEDED)
+			{
+				window.statuses[p] = solved.status;
+				continue;
+			}
+
+			found = window.seen.insert(std::make_pair(key, solved)).first;
+		}
+
+		window.statuses[p] = found->second.status;
+		if (found->second.status == SUDOKU_OK)
+		{
+			invertTransform(transform, found->second.solution, &window.solutions[p * SUDOKU_CELLS]);
+		}
+	}
+}
+
+// Solve every puzzle in the window and write them out in one go
+static bool flushWindow(StreamWindow& window, qqwing::SudokuBoard::PrintStyle style)
+{
+	if (window.count == 0)
+	{
+		return true;
+	}
+
+	if (window.dedupe)
+	{
+		solveDeduplicated(window);
+	}
+	else
+	{
+		sudoku_solve_records(window.puzzles.data(), SUDOKU_CELLS, window.solutions.data(), SUDOKU_CELLS,
+			SUDOKU_RECORD_DIGITS, window.statuses.data(), window.count);
+	}
+
+	char* out = window.output.data();
+	for (size_t p = 0; p < window.count; ++p)
+	{
+		const uint8_t* puzzle = &window.puzzles[p * SUDOKU_CELLS];
+		const uint8_t* solution = &window.solutions[p * SUDOKU_CELLS];
+		sudoku_status status = window.statuses[p];
+
+		if (style == qqwing::SudokuBoard::CSV)
+		{
+			if (puzzle[0] != INVALID_CELL)
+			{
+				out = writeDigits(out, puzzle);
+			}
+			*out++ = ',';
+
+			if (status == SUDOKU_OK)
+			{
+				out = writeDigits(out, solution);
+			}
+			*out++ = ',';
+
+			const char* name = getStatusName(status);
+			size_t length = strlen(name);
+			memcpy(out, name, length);
+			out += length;
+		}
+		else if (status == SUDOKU_OK)
+		{
+			out = writeDigits(out, solution);
+		}
+
+		*out++ = '\n';
+	}
+
+	size_t size = out - window.output.data();
+	window.count = 0;
+
+	return fwrite(window.output.data(), 1, size, stdout) == size && fflush(stdout) == 0;
+}
+
+// Add a puzzle to the window, or an invalid entry for a NULL line, solving and
+// writing the window once it is full
+static bool addPuzzle(StreamWindow& window, const char* line, size_t length, qqwing::SudokuBoard::PrintStyle style)
+{
+	uint8_t* puzzle = &window.puzzles[window.count * SUDOKU_CELLS];
+	if (line == NULL || length < SUDOKU_CELLS || !parseDigits(line, puzzle))
+	{
+		puzzle[0] = INVALID_CELL;
+	}
+
+	++window.count;
+	if (window.count == STREAM_WINDOW)
+	{
+		return flushWindow(window, style);
+	}
+
+	return true;
+}
+
+// Add one line of input to the window, skipping blank lines and comments
+static bool addLine(StreamWindow& window, const char* line, size_t length, qqwing::SudokuBoard::PrintStyle style)
+{
+	if (length > 0 && line[length - 1] == '\r')
+	{
+		--length;
+	}
+
+	if (length == 0 || line[0] == '#')
+	{
+		return true;
+	}
+
+	return addPuzzle(window, line, length, style);
+}
+
+int runStream(qqwing::SudokuBoard::PrintStyle style, bool dedupe)
+{
+	StreamWindow window;
+	window.puzzles.resize(STREAM_WINDOW * SUDOKU_CELLS);
+	window.solutions.resize(STREAM_WINDOW * SUDOKU_CELLS);
+	window.statuses.resize(STREAM_WINDOW);
+	window.output.resize(STREAM_WINDOW * STREAM_MAX_LINE);
+	window.count = 0;
+	window.dedupe = dedupe;
+
+	if (style == qqwing::SudokuBoard::CSV)
+	{
+		fputs("Puzzle,Solution,Status\n", stdout);
+	}
+
+	std::vector<char> input(STREAM_READ_SIZE);
+	size_t have = 0;
+
+	// Set while throwing away the rest of a line too long for the buffer
+	bool skipping = false;
+
+	for (;;)
+	{
+		long n = (long)readInput(input.data() + have, input.size() - have);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+
+			return 1;
+		}
+
+		bool atEnd = (n == 0);
+		have += n;
+
+		// Hand over every complete line, keeping any partial line for the next read
+		const char* begin = input.data();
+		const char* end = begin + have;
+		const char* newline;
+		while ((newline = (const char*)memchr(begin, '\n', end - begin)) != NULL)
+		{
+			if (skipping)
+			{
+				skipping = false;
+			}
+			else if (!addLine(window, begin, newline - begin, style))
+			{
+				return 1;
+			}
+
+			begin = newline + 1;
+		}
+
+		if (atEnd)
+		{
+			if (begin < end && !skipping && !addLine(window, begin, end - begin, style))
+			{
+				return 1;
+			}
+
+			return flushWindow(window, style) ? 0 : 1;
+		}
+
+		have = end - begin;
+		if (have == input.size())
+		{
+			// No puzzle line is this long, so count it once and drop the rest of it
+			if (!skipping && input[0] != '#' && !addPuzzle(window, NULL, 0, style))
+			{
+				return 1;
+			}
+
+			skipping = true;
+			have = 0;
+		}
+		else
+		{
+			memmove(input.data(), begin, have);
+		}
+
+		// Write out what has been read so far before waiting on more input
+		if (!flushWindow(window, style))
+		{
+			return 1;
+		}
+	}
+}
@@ -0,0 +1,23 @@
+#ifndef STREAM_HPP
+#define STREAM_HPP
+
+#include "qqwing.hpp"
+
+// Act as a filter: read puzzles from stdin, one 81 character line each, and
+// write a line per puzzle to stdout in the ONE_LINE or CSV print style.
+//
+// ONE_LINE writes each solution, or an empty line for a puzzle that is invalid,
+// has no solution or runs out of budget. CSV writes a header and then puzzle, solution and status
+// for each puzzle. Blank lines and lines starting with '#' are skipped.
+//
+// At most a window of puzzles is held between reading and writing, and output
+// is flushed once per window rather than per puzzle, so memory stays bounded
+// on unbounded streams.
+//
+// With dedupe, each puzzle is solved in its canonical form, and puzzles that
+// are the same as a recent one up to symmetry reuse its solution.
+//
+// Returns 0, or 1 if reading or writing failed.
+int runStream(qqwing::SudokuBoard::PrintStyle style, bool dedupe = false);
+
+#endif
@@ -0,0 +1,788 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cache.hpp"
+#include "qqwing.hpp"
+#include "solver.hpp"
+#include "store.hpp"
+#include "sudoku.h"
+#include "verify.hpp"
+
+// Give up generating a puzzle of a given difficulty after this many tries
+static const uint32_t MAX_GENERATE_ATTEMPTS = 10000;
+
+// Fallback solver and grader, one per thread so callers never share a board
+static thread_local qqwing::SudokuBoard qqwingBoard;
+
+// Solutions of recent puzzles, if configured
+static std::unique_ptr<SolutionCache> solutionCache;
+
+// Limits on solving each puzzle, 0 for none
+static std::atomic<uint64_t> maxSolveSteps(0);
+static std::atomic<uint64_t> maxSolveMicroseconds(0);
+
+// A QQWING search left to run a slice at a time, and where its result goes
+struct sudoku_search
+{
+	qqwing::SudokuBoard board;
+	sudoku_record_format format;
+
+	// Set when the result is to be added to the cache and store under key
+	bool keyed;
+	CacheKey key;
+};
+
+// A search for the next sudoku_search_begin, only handed out when a puzzle needs QQWING
+static thread_local std::unique_ptr<sudoku_search> spareSearch;
+
+// Solve one record through the cache and store, writing the solution only once the puzzle has been read.
+// Given a search, a puzzle that needs QQWING is left on it and SUDOKU_IN_PROGRESS returned.
+static sudoku_status solveRecord(const uint8_t* puzzle, uint8_t* solution, sudoku_record_format format, sudoku_search* search);
+
+// Look a puzzle up in the solution store, if it is open
+static bool findStored(const CacheKey& key, CachedSolution& value);
+
+// Add a result to the solution store, with the technique counts of graded if it is not NULL
+static void storeSolution(const CacheKey& key, const CachedSolution& value, qqwing::SudokuBoard* graded);
+
+// Solve one record without the cache or store. Given a search board, a puzzle that needs
+// QQWING is set up on it and SUDOKU_IN_PROGRESS returned.
+static sudoku_status solveUncached(const uint8_t* puzzle, uint8_t* solution, sudoku_record_format format, qqwing::SudokuBoard* search);
+
+// Get the status of a finished QQWING search, writing its solution if it found one
+static sudoku_status finishSearch(qqwing::SudokuBoard& board, qqwing::SudokuBoard::SolveState state,
+	uint8_t* solution, sudoku_record_format format);
+
+// Get the value of one cell of a record, 1-9, 0 for a blank or -1 if it is not valid
+static int decodeCell(uint8_t c, sudoku_record_format format);
+
+// Place the givens of a record straight into the solver grid, failing on bad cells or conflicts
+static bool loadRecord(const uint8_t* record, sudoku_record_format format);
+
+// Check that every cell of the solver grid is solved without breaking the rules
+static bool isGridValid();
+
+// Read a puzzle record into 1-9 givens and 0 blanks
+static bool parsePuzzle(const char* text, int* board);
+
+// Check that no two givens in a row, column or box are the same
+static bool hasConflicts(const int* board);
+
+// Check that a grid is complete, follows the rules and keeps the givens of a puzzle
+static bool isValidSolution(const int* board, const int* solution);
+
+// Write a grid as a record of digits
+static void writeRecord(const int* board, char* text);
+
+int sudoku_api_version(void)
+{
+	return SUDOKU_API_VERSION;
+}
+
+sudoku_status sudoku_solve(const char* puzzle, char* solution)
+{
+	if (puzzle == NULL || solution == NULL)
+	{
+		return SUDOKU_INVALID_ARGUMENT;
+	}
+
+	return solveRecord((const uint8_t*)puzzle, (uint8_t*)solution, SUDOKU_RECORD_ASCII, NULL);
+}
+
+size_t sudoku_solve_batch(const char* puzzles, char* solutions, sudoku_status* statuses, size_t count)
+{
+	return sudoku_solve_records((const uint8_t*)puzzles, NUM_CELLS, (uint8_t*)solutions, NUM_CELLS,
+		SUDOKU_RECORD_ASCII, statuses, count);
+}
+
+size_t sudoku_solve_records(const uint8_t* puzzles, size_t puzzle_stride,
+	uint8_t* solutions, size_t solution_stride, sudoku_record_format format,
+	sudoku_status* statuses, size_t count)
+{
+	if (count > 0 && (puzzles == NULL || solutions == NULL))
+	{
+		return 0;
+	}
+
+	size_t numSolved = 0;
+	for (size_t p = 0; p < count; ++p)
+	{
+		sudoku_status status = solveRecord(puzzles + p * puzzle_stride, solutions + p * solution_stride, format, NULL);
+		if (status == SUDOKU_OK)
+		{
+			++numSolved;
+		}
+
+		if (statuses != NULL)
+		{
+			statuses[p] = status;
+		}
+	}
+
+	return numSolved;
+}
+
+sudoku_status sudoku_search_begin(const uint8_t* puzzle, uint8_t* solution,
+	sudoku_record_format format, sudoku_search** search)
+{
+	if (puzzle == NULL || solution == NULL || search == NULL)
+	{
+		return SUDOKU_INVALID_ARGUMENT;
+	}
+
+	if (!spareSearch)
+	{
+		spareSearch.reset(new sudoku_search());
+	}
+
+	spareSearch->format = format;
+	spareSearch->keyed = false;
+	sudoku_status status = solveRecord(puzzle, solution, format, spareSearch.get());
+	*search = (status == SUDOKU_IN_PROGRESS) ? spareSearch.release() : NULL;
+	return status;
+}
+
+sudoku_status sudoku_search_continue(sudoku_search* search, uint64_t steps, uint8_t* solution)
+{
+	if (search == NULL || solution == NULL)
+	{
+		return SUDOKU_INVALID_ARGUMENT;
+	}
+
+	qqwing::SudokuBoard::SolveState state = search->board.continueSolve(steps);
+	if (state == qqwing::SudokuBoard::SOLVING)
+	{
+		return SUDOKU_IN_PROGRESS;
+	}
+
+	CachedSolution cached;
+	cached.status = (uint8_t)finishSearch(search->board, state, cached.solution, SUDOKU_RECORD_DIGITS);
+	cached.difficulty = SUDOKU_DIFFICULTY_UNKNOWN;
+
+	if (search->keyed && cached.status != SUDOKU_BUDGET_EXCEEDED)
+	{
+		storeSolution(search->key, cached, NULL);
+		if (solutionCache)
+		{
+			solutionCache->insert(search->key, cached);
+		}
+	}
+
+	if (cached.status == SUDOKU_OK)
+	{
+		uint8_t zero = (search->format == SUDOKU_RECORD_ASCII) ? '0' : 0;
+		for (uint16_t i = 0; i < NUM_CELLS; ++i)
+		{
+			solution[i] = (uint8_t)(zero + cached.solution[i]);
+		}
+	}
+
+	delete search;
+	return (sudoku_status)cached.status;
+}
+
+void sudoku_search_cancel(sudoku_search* search)
+{
+	delete search;
+}
+
+sudoku_status sudoku_verify(const char* puzzle, const char* solution)
+{
+	if (puzzle == NULL || solution == NULL)
+	{
+		return SUDOKU_INVALID_ARGUMENT;
+	}
+
+	int board[NUM_CELLS];
+	if (!parsePuzzle(puzzle, board))
+	{
+		return SUDOKU_INVALID_PUZZLE;
+	}
+
+	int result[NUM_CELLS];
+	if (!parsePuzzle(solution, result) || !isValidSolution(board, result))
+	{
+		return SUDOKU_INVALID_SOLUTION;
+	}
+
+	return SUDOKU_OK;
+}
+
+sudoku_status sudoku_grade(const char* puzzle, sudoku_difficulty* difficulty)
+{
+	if (puzzle == NULL || difficulty == NULL)
+	{
+		return SUDOKU_INVALID_ARGUMENT;
+	}
+
+	int board[NUM_CELLS];
+	if (!parsePuzzle(puzzle, board) || hasConflicts(board))
+	{
+		return SUDOKU_INVALID_PUZZLE;
+	}
+
+	CacheKey key;
+	CachedSolution cached;
+	if (solutionCache || getSolutionStore().isOpen())
+	{
+		uint8_t digits[NUM_CELLS];
+		for (uint16_t i = 0; i < NUM_CELLS; ++i)
+		{
+			digits[i] = (uint8_t)board[i];
+		}
+		makeCacheKey(digits, key);
+
+		if (solutionCache && solutionCache->find(key, cached) && cached.difficulty != SUDOKU_DIFFICULTY_UNKNOWN)
+		{
+			*difficulty = (sudoku_difficulty)cached.difficulty;
+			return SUDOKU_OK;
+		}
+
+		if (findStored(key, cached) && cached.difficulty != SUDOKU_DIFFICULTY_UNKNOWN)
+		{
+			if (solutionCache)
+			{
+				solutionCache->insert(key, cached);
+			}
+
+			*difficulty = (sudoku_difficulty)cached.difficulty;
+			return SUDOKU_OK;
+		}
+	}
+
+	// Grading works from the history of moves QQWING used to solve the puzzle, which
+	// batch solving would attribute differently
+	qqwingBoard.setRecordHistory(true);
+	qqwingBoard.setBatchSolve(false);
+	qqwingBoard.setPuzzle(board);
+	qqwingBoard.setSolveLimits(maxSolveSteps, maxSolveMicroseconds);
+	bool solved = qqwingBoard.solve();
+	*difficulty = solved ? (sudoku_difficulty)qqwingBoard.getDifficulty() : SUDOKU_DIFFICULTY_UNKNOWN;
+
+	if (!solved && qqwingBoard.isLimitExceeded())
+	{
+		return SUDOKU_BUDGET_EXCEEDED;
+	}
+
+	if (solutionCache || getSolutionStore().isOpen())
+	{
+		cached.status = solved ? SUDOKU_OK : SUDOKU_NO_SOLUTION;
+		cached.difficulty = (uint8_t)*difficulty;
+		const int* result = qqwingBoard.getSolution();
+		for (uint16_t i = 0; i < NUM_CELLS; ++i)
+		{
+			cached.solution[i] = (uint8_t)result[i];
+		}
+
+		if (solutionCache)
+		{
+			solutionCache->insert(key, cached);
+		}
+		storeSolution(key, cached, &qqwingBoard);
+	}
+
+	return solved ? SUDOKU_OK : SUDOKU_NO_SOLUTION;
+}
+
+sudoku_status sudoku_generate(sudoku_difficulty difficulty, char* puzzle, char* solution)
+{
+	if (puzzle == NULL || difficulty < SUDOKU_DIFFICULTY_UNKNOWN || difficulty > SUDOKU_DIFFICULTY_EXPERT)
+	{
+		return SUDOKU_INVALID_ARGUMENT;
+	}
+
+	// Generated puzzles always have a solution, so grading them runs to the end
+	qqwingBoard.setSolveLimits(0, 0);
+	qqwingBoard.setBatchSolve(false);
+
+	for (uint32_t attempt = 0; attempt < MAX_GENERATE_ATTEMPTS; ++attempt)
+	{
+		qqwingBoard.generatePuzzle();
+		qqwingBoard.setRecordHistory(true);
+		qqwingBoard.solve();
+
+		if (difficulty == SUDOKU_DIFFICULTY_UNKNOWN ||
+			(sudoku_difficulty)qqwingBoard.getDifficulty() == difficulty)
+		{
+			writeRecord(qqwingBoard.getPuzzle(), puzzle);
+			if (solution != NULL)
+			{
+				writeRecord(qqwingBoard.getSolution(), solution);
+			}
+
+			return SUDOKU_OK;
+		}
+	}
+
+	return SUDOKU_GENERATE_FAILED;
+}
+
+void sudoku_cache_configure(size_t capacity)
+{
+	solutionCache.reset(capacity == 0 ? NULL : new SolutionCache(capacity));
+}
+
+void sudoku_cache_get_stats(sudoku_cache_stats* stats)
+{
+	if (stats == NULL)
+	{
+		return;
+	}
+
+	memset(stats, 0, sizeof(*stats));
+	if (solutionCache)
+	{
+		CacheStats cacheStats = solutionCache->getStats();
+		stats->hits = cacheStats.hits;
+		stats->misses = cacheStats.misses;
+		stats->insertions = cacheStats.insertions;
+		stats->evictions = cacheStats.evictions;
+		stats->entries = cacheStats.entries;
+		stats->capacity = cacheStats.capacity;
+	}
+}
+
+sudoku_status sudoku_store_open(const char* path, size_t capacity)
+{
+	if (path == NULL || capacity == 0)
+	{
+		return SUDOKU_INVALID_ARGUMENT;
+	}
+
+	return getSolutionStore().open(path, capacity) ? SUDOKU_OK : SUDOKU_STORE_FAILED;
+}
+
+sudoku_status sudoku_store_find(const char* puzzle, char* solution,
+	sudoku_difficulty* difficulty, sudoku_grade_counts* counts)
+{
+	if (puzzle == NULL)
+	{
+		return SUDOKU_INVALID_ARGUMENT;
+	}
+
+	int board[NUM_CELLS];
+	if (!parsePuzzle(puzzle, board))
+	{
+		return SUDOKU_INVALID_PUZZLE;
+	}
+
+	uint8_t digits[NUM_CELLS];
+	for (uint16_t i = 0; i < NUM_CELLS; ++i)
+	{
+		digits[i] = (uint8_t)board[i];
+	}
+
+	CacheKey key;
+	StoredSolution stored;
+	makeCacheKey(digits, key);
+	if (!getSolutionStore().find(key, stored))
+	{
+		return SUDOKU_NOT_FOUND;
+	}
+
+	if (solution != NULL && stored.status == SUDOKU_OK)
+	{
+		for (uint16_t i = 0; i < NUM_CELLS; ++i)
+		{
+			solution[i] = (char)('0' + stored.solution[i]);
+		}
+	}
+
+	if (difficulty != NULL)
+	{
+		*difficulty = (sudoku_difficulty)stored.difficulty;
+	}
+
+	if (counts != NULL)
+	{
+		counts->givens = stored.counts[0];
+		counts->singles = stored.counts[1];
+		counts->hidden_singles = stored.counts[2];
+		counts->naked_pairs = stored.counts[3];
+		counts->hidden_pairs = stored.counts[4];
+		counts->pointing_pairs_triples = stored.counts[5];
+		counts->box_line_reductions = stored.counts[6];
+		counts->guesses = stored.counts[7];
+		counts->backtracks = stored.counts[8];
+	}
+
+	return (sudoku_status)stored.status;
+}
+
+void sudoku_store_close(void)
+{
+	getSolutionStore().close();
+}
+
+void sudoku_set_limits(uint64_t max_steps, uint64_t max_microseconds)
+{
+	maxSolveSteps = max_steps;
+	maxSolveMicroseconds = max_microseconds;
+}
+
+void sudoku_seed(unsigned int seed)
+{
+	srand(seed);
+}
+
+// Solve one record through the cache and store, writing the solution only once the puzzle has been read
+static sudoku_status solveRecord(const uint8_t* puzzle, uint8_t* solution, sudoku_record_format format, sudoku_search* search)
+{
+	qqwing::SudokuBoard* searchBoard = (search != NULL) ? &search->board : NULL;
+	if (!solutionCache && !getSolutionStore().isOpen())
+	{
+		return solveUncached(puzzle, solution, format, searchBoard);
+	}
+
+	uint8_t digits[NUM_CELLS];
+	for (uint16_t i = 0; i < NUM_CELLS; ++i)
+	{
+		int value = decodeCell(puzzle[i], format);
+		if (value < 0)
+		{
+			return SUDOKU_INVALID_PUZZLE;
+		}
+		digits[i] = (uint8_t)value;
+	}
+
+	CacheKey key;
+	makeCacheKey(digits, key);
+
+	CachedSolution cached;
+	if (!solutionCache || !solutionCache->find(key, cached))
+	{
+		if (!findStored(key, cached))
+		{
+			cached.status = (uint8_t)solveUncached(digits, cached.solution, SUDOKU_RECORD_DIGITS, searchBoard);
+			cached.difficulty = SUDOKU_DIFFICULTY_UNKNOWN;
+
+			// Invalid puzzles are quicker to spot again than to look up, and puzzles
+			// given up on might be solved with more time
+			if (cached.status == SUDOKU_INVALID_PUZZLE || cached.status == SUDOKU_BUDGET_EXCEEDED)
+			{
+				return (sudoku_status)cached.status;
+			}
+
+			// A search adds its result once it finishes
+			if (cached.status == SUDOKU_IN_PROGRESS)
+			{
+				search->keyed = true;
+				search->key = key;
+				return SUDOKU_IN_PROGRESS;
+			}
+
+			storeSolution(key, cached, NULL);
+		}
+
+		if (solutionCache)
+		{
+			solutionCache->insert(key, cached);
+		}
+	}
+
+	if (cached.status == SUDOKU_OK)
+	{
+		uint8_t zero = (format == SUDOKU_RECORD_ASCII) ? '0' : 0;
+		for (uint16_t i = 0; i < NUM_CELLS; ++i)
+		{
+			solution[i] = (uint8_t)(zero + cached.solution[i]);
+		}
+	}
+
+	return (sudoku_status)cached.status;
+}
+
+// Look a puzzle up in the solution store, if it is open
+static bool findStored(const CacheKey& key, CachedSolution& value)
+{
+	StoredSolution stored;
+	if (!getSolutionStore().find(key, stored))
+	{
+		return false;
+	}
+
+	value.status = stored.status;
+	value.difficulty = stored.difficulty;
+	memcpy(value.solution, stored.solution, sizeof(value.solution));
+	return true;
+}
+
+// Add a result to the solution store, with the technique counts of graded if it is not NULL
+static void storeSolution(const CacheKey& key, const CachedSolution& value, qqwing::SudokuBoard* graded)
+{
+	SolutionStore& store = getSolutionStore();
+	if (!store.isOpen())
+	{
+		return;
+	}
+
+	StoredSolution stored;
+	memset(&stored, 0, sizeof(stored));
+	stored.status = value.status;
+	stored.difficulty = value.difficulty;
+	memcpy(stored.solution, value.solution, sizeof(stored.solution));
+
+	if (graded != NULL)
+	{
+		stored.counts[0] = (uint16_t)graded->getGivenCount();
+		stored.counts[1] = (uint16_t)graded->getSingleCount();
+		stored.counts[2] = (uint16_t)graded->getHiddenSingleCount();
+		stored.counts[3] = (uint16_t)graded->getNakedPairCount();
+		stored.counts[4] = (uint16_t)graded->getHiddenPairCount();
+		stored.counts[5] = (uint16_t)graded->getPointingPairTripleCount();
+		stored.counts[6] = (uint16_t)graded->getBoxLineReductionCount();
+		stored.counts[7] = (uint16_t)graded->getGuessCount();
+		stored.counts[8] = (uint16_t)graded->getBacktrackCount();
+	}
+
+	store.insert(key, stored);
+}
+
+// Solve one record without the cache or store
+static sudoku_status solveUncached(const uint8_t* puzzle, uint8_t* solution, sudoku_record_format format, qqwing::SudokuBoard* search)
+{
+	uint8_t zero = (format == SUDOKU_RECORD_ASCII) ? '0' : 0;
+	uint64_t steps = maxSolveSteps;
+	uint64_t microseconds = maxSolveMicroseconds;
+	auto start = std::chrono::steady_clock::now();
+
+	// Try the logical solver first, it is much faster when it gets there
+	if (!loadRecord(puzzle, format))
+	{
+		return SUDOKU_INVALID_PUZZLE;
+	}
+
+	setSolveLimits(steps, microseconds);
+	solveGrid();
+
+	if (isGridValid())
+	{
+		for (uint16_t i = 0; i < NUM_CELLS; ++i)
+		{
+			solution[i] = (uint8_t)(zero + (grid[i] & ~SOLVED));
+		}
+
+		return SUDOKU_OK;
+	}
+
+	// Otherwise let QQWING guess its way through
+	int board[NUM_CELLS];
+	for (uint16_t i = 0; i < NUM_CELLS; ++i)
+	{
+		board[i] = decodeCell(puzzle[i], format);
+	}
+
+	if (isSolveLimitExceeded())
+	{
+		return SUDOKU_BUDGET_EXCEEDED;
+	}
+
+	// QQWING gets whatever steps and time the logical solver left
+	uint64_t remainingSteps = 0;
+	if (steps != 0)
+	{
+		uint64_t used = getSolveSteps();
+		if (used >= steps)
+		{
+			return SUDOKU_BUDGET_EXCEEDED;
+		}
+		remainingSteps = steps - used;
+	}
+
+	uint64_t remaining = 0;
+	if (microseconds != 0)
+	{
+		uint64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+		if (elapsed >= microseconds)
+		{
+			return SUDOKU_BUDGET_EXCEEDED;
+		}
+		remaining = microseconds - elapsed;
+	}
+
+	// Only the solution is wanted, so every single a sweep finds can be placed at once
+	qqwing::SudokuBoard& fallback = (search != NULL) ? *search : qqwingBoard;
+	fallback.setRecordHistory(false);
+	fallback.setBatchSolve(true);
+	fallback.setPuzzle(board);
+	fallback.setSolveLimits(remainingSteps, remaining);
+	fallback.beginSolve();
+	if (search != NULL)
+	{
+		return SUDOKU_IN_PROGRESS;
+	}
+
+	return finishSearch(fallback, fallback.continueSolve(0), solution, format);
+}
+
+// Get the status of a finished QQWING search, writing its solution if it found one
+static sudoku_status finishSearch(qqwing::SudokuBoard& board, qqwing::SudokuBoard::SolveState state,
+	uint8_t* solution, sudoku_record_format format)
+{
+	if (state != qqwing::SudokuBoard::SOLVED)
+	{
+		return board.isLimitExceeded() ? SUDOKU_BUDGET_EXCEEDED : SUDOKU_NO_SOLUTION;
+	}
+
+	uint8_t zero = (format == SUDOKU_RECORD_ASCII) ? '0' : 0;
+	const int* result = board.getSolution();
+	for (uint16_t i = 0; i < NUM_CELLS; ++i)
+	{
+		solution[i] = (uint8_t)(zero + result[i]);
+	}
+
+	return SUDOKU_OK;
+}
+
+// Get the value of one cell of a record, 1-9, 0 for a blank or -1 if it is not valid
+static int decodeCell(uint8_t c, sudoku_record_format format)
+{
+	if (format == SUDOKU_RECORD_ASCII)
+	{
+		if (c == '.')
+		{
+			return 0;
+		}
+
+		c -= '0';
+	}
+
+	return (c <= 9) ? c : -1;
+}
+
+// Place the givens of a record straight into the solver grid, failing on bad cells or conflicts
+static bool loadRecord(const uint8_t* record, sudoku_record_format format)
+{
+	uint16_t rows[ROWS] = { 0 };
+	uint16_t cols[COLS] = { 0 };
+	uint16_t boxes[BOXES] = { 0 };
+
+	for (uint16_t i = 0; i < NUM_CELLS; ++i)
+	{
+		grid[i] = 0x03FE;
+	}
+
+	for (uint16_t i = 0; i < NUM_CELLS; ++i)
+	{
+		int value = decodeCell(record[i], format);
+		if (value <= 0)
+		{
+			if (value < 0)
+			{
+				return false;
+			}
+
+			continue;
+		}
+
+		uint16_t row = i / COLS;
+		uint16_t col = i % COLS;
+		uint16_t box = (row / DIMENSION) * DIMENSION + col / DIMENSION;
+		uint16_t bit = 1 << value;
+
+		if ((rows[row] | cols[col] | boxes[box]) & bit)
+		{
+			return false;
+		}
+
+		rows[row] |= bit;
+		cols[col] |= bit;
+		boxes[box] |= bit;
+
+		updateCell(i, value, true);
+	}
+
+	return true;
+}
+
+// Check that every cell of the solver grid is solved without breaking the rules
+static bool isGridValid()
+{
+	// Givens are never overwritten, so a finished grid is a solution
+	uint8_t digits[NUM_CELLS];
+	getGridDigits(digits);
+
+	return isValidGrid(digits);
+}
+
+// Read a puzzle record into 1-9 givens and 0 blanks
+static bool parsePuzzle(const char* text, int* board)
+{
+	for (uint16_t i = 0; i < NUM_CELLS; ++i)
+	{
+		char c = text[i];
+		if (c >= '1' && c <= '9')
+		{
+			board[i] = c - '0';
+		}
+		else if (c == '0' || c == '.')
+		{
+			board[i] = 0;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Check that no two givens in a row, column or box are the same
+static bool hasConflicts(const int* board)
+{
+	uint16_t rows[ROWS] = { 0 };
+	uint16_t cols[COLS] = { 0 };
+	uint16_t boxes[BOXES] = { 0 };
+
+	for (uint16_t i = 0; i < NUM_CELLS; ++i)
+	{
+		if (board[i] == 0)
+		{
+			continue;
+		}
+
+		uint16_t row = i / COLS;
+		uint16_t col = i % COLS;
+		uint16_t box = (row / DIMENSION) * DIMENSION + col / DIMENSION;
+		uint16_t bit = 1 << board[i];
+
+		if ((rows[row] | cols[col] | boxes[box]) & bit)
+		{
+			return true;
+		}
+
+		rows[row] |= bit;
+		cols[col] |= bit;
+		boxes[box] |= bit;
+	}
+
+	return false;
+}
+
+// Check that a grid is complete, follows the rules and keeps the givens of a puzzle
+static bool isValidSolution(const int* board, const int* solution)
+{
+	uint8_t puzzle[NUM_CELLS];
+	uint8_t digits[NUM_CELLS];
+	for (uint16_t i = 0; i < NUM_CELLS; ++i)
+	{
+		puzzle[i] = (uint8_t)board[i];
+		digits[i] = (uint8_t)solution[i];
+	}
+
+	return isSolutionOf(puzzle, digits);
+}
+
+// Write a grid as a record of digits
+static void writeRecord(const int* board, char* text)
+{
+	for (uint16_t i = 0; i < NUM_CELLS; ++i)
+	{
+		text[i] = (char)('0' + board[i]);
+	}
+}
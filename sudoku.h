@@ -0,0 +1,221 @@
+#ifndef SUDOKU_H
+#define SUDOKU_H
+
+// C interface to the solving engine, for embedding the solver in other programs.
+//
+// Puzzles and solutions are passed as 81 character records in row order, with no
+// terminating NUL. Puzzles use '1'-'9' for givens and '0' or '.' for blanks, and
+// solutions are always written as '1'-'9'.
+//
+// Solving, verifying and grading may be called from several threads at once, as
+// each thread solves with its own engine state. The exceptions:
+// - sudoku_cache_configure, sudoku_store_open and sudoku_store_close must not be
+//   called while other threads are solving
+// - sudoku_generate and sudoku_seed share the C library rand(), so only one
+//   thread at a time may call either of them
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+	#if defined(SUDOKU_BUILD_SHARED)
+		#define SUDOKU_API __declspec(dllexport)
+	#elif defined(SUDOKU_USE_SHARED)
+		#define SUDOKU_API __declspec(dllimport)
+	#else
+		#define SUDOKU_API
+	#endif
+#elif defined(__GNUC__)
+	#define SUDOKU_API __attribute__((visibility("default")))
+#else
+	#define SUDOKU_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bumped whenever a function or type below changes incompatibly
+#define SUDOKU_API_VERSION 1
+
+// Length of a puzzle or solution record
+#define SUDOKU_CELLS 81
+
+typedef enum sudoku_status
+{
+	SUDOKU_OK = 0,
+
+	// A NULL buffer or out of range argument
+	SUDOKU_INVALID_ARGUMENT = 1,
+
+	// The puzzle contains a character other than 0-9 or '.', or its givens conflict
+	SUDOKU_INVALID_PUZZLE = 2,
+
+	// The puzzle is well formed but cannot be completed
+	SUDOKU_NO_SOLUTION = 3,
+
+	// A solution passed to sudoku_verify is incomplete, breaks the rules or ignores a given
+	SUDOKU_INVALID_SOLUTION = 4,
+
+	// No puzzle of the requested difficulty turned up within the attempt limit
+	SUDOKU_GENERATE_FAILED = 5,
+
+	// The solution store file could not be created, opened or mapped
+	SUDOKU_STORE_FAILED = 6,
+
+	// Solving gave up on reaching the limits set by sudoku_set_limits
+	SUDOKU_BUDGET_EXCEEDED = 7,
+
+	// The puzzle is not in the solution store, or no store is open
+	SUDOKU_NOT_FOUND = 8,
+
+	// A search started by sudoku_search_begin has more to do
+	SUDOKU_IN_PROGRESS = 9
+} sudoku_status;
+
+// Layouts of the records read and written by sudoku_solve_records
+typedef enum sudoku_record_format
+{
+	// One byte per cell holding 1-9, or 0 for a blank
+	SUDOKU_RECORD_DIGITS = 0,
+
+	// One character per cell, as for sudoku_solve
+	SUDOKU_RECORD_ASCII = 1
+} sudoku_record_format;
+
+// Counters for the solution cache
+typedef struct sudoku_cache_stats
+{
+	uint64_t hits;
+	uint64_t misses;
+	uint64_t insertions;
+	uint64_t evictions;
+	uint64_t entries;
+	uint64_t capacity;
+} sudoku_cache_stats;
+
+// Difficulty ratings, as graded by QQWING
+typedef enum sudoku_difficulty
+{
+	SUDOKU_DIFFICULTY_UNKNOWN = 0,
+	SUDOKU_DIFFICULTY_SIMPLE = 1,
+	SUDOKU_DIFFICULTY_EASY = 2,
+	SUDOKU_DIFFICULTY_INTERMEDIATE = 3,
+	SUDOKU_DIFFICULTY_EXPERT = 4
+} sudoku_difficulty;
+
+// How many times QQWING used each technique while grading a puzzle
+typedef struct sudoku_grade_counts
+{
+	uint32_t givens;
+	uint32_t singles;
+	uint32_t hidden_singles;
+	uint32_t naked_pairs;
+	uint32_t hidden_pairs;
+	uint32_t pointing_pairs_triples;
+	uint32_t box_line_reductions;
+	uint32_t guesses;
+	uint32_t backtracks;
+} sudoku_grade_counts;
+
+// The SUDOKU_API_VERSION the library was built with
+SUDOKU_API int sudoku_api_version(void);
+
+// Solve one puzzle, writing SUDOKU_CELLS digits to solution on success.
+// Puzzles with several solutions get one of them.
+SUDOKU_API sudoku_status sudoku_solve(const char* puzzle, char* solution);
+
+// Solve count puzzles stored back to back, writing the solutions back to back.
+// The status of each puzzle is written to statuses unless it is NULL.
+// Returns the number of puzzles solved.
+SUDOKU_API size_t sudoku_solve_batch(const char* puzzles, char* solutions, sudoku_status* statuses, size_t count);
+
+// Solve count puzzles read straight out of a caller owned buffer, writing each
+// solution straight into another, with no allocation or copying per puzzle.
+// Record i starts at puzzles + i * puzzle_stride and its solution at
+// solutions + i * solution_stride, so a stride of 82 walks newline separated
+// lines. Solutions may overwrite their puzzles in place. Unsolved records are
+// left untouched. The status of each puzzle is written to statuses unless it
+// is NULL. Returns the number of puzzles solved.
+SUDOKU_API size_t sudoku_solve_records(const uint8_t* puzzles, size_t puzzle_stride,
+	uint8_t* solutions, size_t solution_stride, sudoku_record_format format,
+	sudoku_status* statuses, size_t count);
+
+// A solve run a slice at a time, so one thread can take turns between many puzzles
+// without a long search holding up the rest
+typedef struct sudoku_search sudoku_search;
+
+// Start solving one record the way sudoku_solve_records does. A puzzle answered by
+// the cache, the store or the logical solver is finished at once: its status is
+// returned, the solution is written for SUDOKU_OK and *search is set to NULL. A
+// puzzle that needs guessing returns SUDOKU_IN_PROGRESS and sets *search to a
+// search to run with sudoku_search_continue.
+SUDOKU_API sudoku_status sudoku_search_begin(const uint8_t* puzzle, uint8_t* solution,
+	sudoku_record_format format, sudoku_search** search);
+
+// Run a search for up to steps guesses and propagation steps, or to the end for 0.
+// Returns SUDOKU_IN_PROGRESS while there is more to do. Otherwise the search is
+// freed and its final status returned, with the solution written for SUDOKU_OK in
+// the format the search began with. A search may move between threads from one
+// call to the next, but only one thread may run it at a time.
+SUDOKU_API sudoku_status sudoku_search_continue(sudoku_search* search, uint64_t steps, uint8_t* solution);
+
+// Free a search that is still in progress without finishing it
+SUDOKU_API void sudoku_search_cancel(sudoku_search* search);
+
+// Check that solution is a complete, valid grid that agrees with the givens of puzzle
+SUDOKU_API sudoku_status sudoku_verify(const char* puzzle, const char* solution);
+
+// Rate how hard a puzzle is to solve by hand
+SUDOKU_API sudoku_status sudoku_grade(const char* puzzle, sudoku_difficulty* difficulty);
+
+// Generate a puzzle with a unique solution and the given difficulty, or of any
+// difficulty for SUDOKU_DIFFICULTY_UNKNOWN. solution may be NULL.
+SUDOKU_API sudoku_status sudoku_generate(sudoku_difficulty difficulty, char* puzzle, char* solution);
+
+// Put a cache of up to capacity solutions, keyed by the givens of each puzzle,
+// in front of sudoku_solve, sudoku_solve_batch, sudoku_solve_records, searches
+// and sudoku_grade, or remove it with a capacity of 0. Any cached solutions are
+// dropped. Must not be called while other threads are solving.
+SUDOKU_API void sudoku_cache_configure(size_t capacity);
+
+// Get the cache counters, all zero when there is no cache
+SUDOKU_API void sudoku_cache_get_stats(sudoku_cache_stats* stats);
+
+// Keep solutions in a file that outlives the process and is shared with any
+// other process that opens it, consulted after the cache and before solving in
+// sudoku_solve, sudoku_solve_batch, sudoku_solve_records, searches and sudoku_grade.
+// A new file gets room for capacity solutions; an existing one keeps its own
+// size. A puzzle solved before it is graded gets its grade and technique counts
+// added the first time it is graded. Not available on Windows. Must not be
+// called while other threads are solving.
+SUDOKU_API sudoku_status sudoku_store_open(const char* path, size_t capacity);
+
+// Look a puzzle up in the solution store without solving or grading it. Returns
+// the stored status: for SUDOKU_OK the solution is written unless solution is
+// NULL. The difficulty and technique counts are written unless NULL, with
+// SUDOKU_DIFFICULTY_UNKNOWN and zero counts for puzzles not graded yet.
+// Returns SUDOKU_NOT_FOUND if the puzzle has not been stored.
+SUDOKU_API sudoku_status sudoku_store_find(const char* puzzle, char* solution,
+	sudoku_difficulty* difficulty, sudoku_grade_counts* counts);
+
+// Stop using the solution store, leaving the file in place. Must not be called
+// while other threads are solving.
+SUDOKU_API void sudoku_store_close(void);
+
+// Give up on any puzzle that takes more than max_steps propagation steps and
+// guesses across both solvers, or more than max_microseconds in all, returning
+// SUDOKU_BUDGET_EXCEEDED. Zero means no limit. Applies to sudoku_solve,
+// sudoku_solve_batch, sudoku_solve_records, searches and sudoku_grade on every
+// thread, per puzzle. A search counts only the time spent running it, not the
+// time between calls. Puzzles given up on are never cached or stored.
+SUDOKU_API void sudoku_set_limits(uint64_t max_steps, uint64_t max_microseconds);
+
+// Seed the random numbers used by sudoku_generate (the C library rand())
+SUDOKU_API void sudoku_seed(unsigned int seed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,138 @@
+#include "verify.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define VERIFY_SSE2
+#endif
+
+static const uint16_t GRID_CELLS = 81;
+static const uint16_t GRID_SIZE = 9;
+
+// Every digit present in a unit
+static const uint16_t ALL_DIGITS = 0x1FF;
+
+// Each cell as a bit for its digit, 0 for blanks and anything out of range.
+// A unit with a 0 cell has at most 8 bits set between its other cells, so
+// such cells can never pass.
+static void getDigitBits(const uint8_t* digits, uint16_t* bits)
+{
+	for (uint16_t i = 0; i < GRID_CELLS; ++i)
+	{
+		uint16_t digit = digits[i];
+		bits[i] = (uint16_t)(digit - 1u < GRID_SIZE ? 1u << (digit - 1u) : 0u);
+	}
+}
+
+#ifdef VERIFY_SSE2
+
+// Each row is one load of its first 8 cells, with the 9th cell kept apart. OR
+// down the rows gives the columns, OR across each row gives the row, and OR
+// across neighbouring lanes of three rows gives the boxes of a band.
+static bool areUnitsComplete(const uint16_t* bits)
+{
+	const __m128i all = _mm_set1_epi16(ALL_DIGITS);
+	__m128i columns = _mm_setzero_si128();
+	uint16_t lastColumn = 0;
+	bool complete = true;
+
+	for (uint16_t band = 0; band < GRID_SIZE; band += 3)
+	{
+		__m128i bandBits = _mm_setzero_si128();
+		uint16_t bandLast = 0;
+
+		for (uint16_t row = band; row < band + 3; ++row)
+		{
+			__m128i rowBits = _mm_loadu_si128((const __m128i*)&bits[row * GRID_SIZE]);
+			uint16_t last = bits[row * GRID_SIZE + 8];
+			bandBits = _mm_or_si128(bandBits, rowBits);
+			bandLast |= last;
+
+			__m128i across = _mm_or_si128(rowBits, _mm_srli_si128(rowBits, 8));
+			across = _mm_or_si128(across, _mm_srli_si128(across, 4));
+			across = _mm_or_si128(across, _mm_srli_si128(across, 2));
+			complete &= (((uint16_t)_mm_cvtsi128_si32(across) | last) == ALL_DIGITS);
+		}
+
+		columns = _mm_or_si128(columns, bandBits);
+		lastColumn |= bandLast;
+
+		// Lanes 0, 3 and 6 end up holding the boxes, the third missing its 9th column
+		__m128i boxes = _mm_or_si128(bandBits, _mm_srli_si128(bandBits, 2));
+		boxes = _mm_or_si128(boxes, _mm_srli_si128(bandBits, 4));
+		complete &= ((uint16_t)_mm_extract_epi16(boxes, 0) == ALL_DIGITS);
+		complete &= ((uint16_t)_mm_extract_epi16(boxes, 3) == ALL_DIGITS);
+		complete &= (((uint16_t)_mm_extract_epi16(boxes, 6) | bandLast) == ALL_DIGITS);
+	}
+
+	complete &= (_mm_movemask_epi8(_mm_cmpeq_epi16(columns, all)) == 0xFFFF);
+	complete &= (lastColumn == ALL_DIGITS);
+
+	return complete;
+}
+
+#else
+
+static bool areUnitsComplete(const uint16_t* bits)
+{
+	uint16_t rows[GRID_SIZE] = {0};
+	uint16_t cols[GRID_SIZE] = {0};
+	uint16_t boxes[GRID_SIZE] = {0};
+
+	for (uint16_t i = 0; i < GRID_CELLS; ++i)
+	{
+		uint16_t row = i / GRID_SIZE;
+		uint16_t col = i % GRID_SIZE;
+		rows[row] |= bits[i];
+		cols[col] |= bits[i];
+		boxes[(row / 3) * 3 + col / 3] |= bits[i];
+	}
+
+	uint16_t complete = ALL_DIGITS;
+	for (uint16_t u = 0; u < GRID_SIZE; ++u)
+	{
+		complete &= rows[u] & cols[u] & boxes[u];
+	}
+
+	return complete == ALL_DIGITS;
+}
+
+#endif
+
+bool isValidGrid(const uint8_t* digits)
+{
+	uint16_t bits[GRID_CELLS];
+	getDigitBits(digits, bits);
+
+	return areUnitsComplete(bits);
+}
+
+bool isSolutionOf(const uint8_t* puzzle, const uint8_t* solution)
+{
+#ifdef VERIFY_SSE2
+	// Sixteen cells at a time, each either blank in the puzzle or the same in both
+	const __m128i zero = _mm_setzero_si128();
+	uint16_t i = 0;
+	for (; i + 16 <= GRID_CELLS; i += 16)
+	{
+		__m128i given = _mm_loadu_si128((const __m128i*)&puzzle[i]);
+		__m128i solved = _mm_loadu_si128((const __m128i*)&solution[i]);
+		__m128i kept = _mm_or_si128(_mm_cmpeq_epi8(given, zero), _mm_cmpeq_epi8(given, solved));
+		if (_mm_movemask_epi8(kept) != 0xFFFF)
+		{
+			return false;
+		}
+	}
+#else
+	uint16_t i = 0;
+#endif
+
+	for (; i < GRID_CELLS; ++i)
+	{
+		if (puzzle[i] != 0 && puzzle[i] != solution[i])
+		{
+			return false;
+		}
+	}
+
+	return isValidGrid(solution);
+}
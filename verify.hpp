@@ -0,0 +1,14 @@
+#ifndef VERIFY_HPP
+#define VERIFY_HPP
+
+#include <stdint.h>
+
+// Check that 81 digits form a finished grid: every row, column and box holds
+// each of 1-9 exactly once. Blanks (0) or anything above 9 fail.
+bool isValidGrid(const uint8_t* digits);
+
+// Check that a solution is a finished grid that keeps every given of a puzzle
+// (1-9, 0 for blanks), without needing to solve the puzzle again
+bool isSolutionOf(const uint8_t* puzzle, const uint8_t* solution);
+
+#endif